@@ -150,6 +150,7 @@ def generate_sudoku(column) -> None:
     cwd = os.getcwd()
     seeds_path = os.path.join(cwd, "src", "Seeds")
     tmp_path = os.path.join(cwd, "src", "Tmp")
+    pool_path = os.path.join(cwd, "src", "Tmp", "puzzle-pool.bin")
 
     with column:
         with stylable_container(
@@ -164,12 +165,26 @@ def generate_sudoku(column) -> None:
                 st.error("Please select a level.")
                 return None
 
+            # Serve a pre-generated puzzle when available, then top up the pool in the background.
+            # Executables built without the pool reject these options: generate directly with them instead
+            generator_args = [str(st.session_state.sudoku_level), str(seeds_path), str(tmp_path)]
             with st.spinner("Generating..."):
                 execution = call_exe(
                     file_name=os.path.join(cwd, "run_generator.exe"),
-                    input=[str(st.session_state.sudoku_level), str(seeds_path), str(tmp_path)],
+                    input=generator_args + ["--pool", str(pool_path)],
                     timeout=15
                 )
+                if execution:
+                    spawn_exe(
+                        file_name=os.path.join(cwd, "run_generator.exe"),
+                        input=generator_args + ["--pool", str(pool_path), "--refill"]
+                    )
+                else:
+                    execution = call_exe(
+                        file_name=os.path.join(cwd, "run_generator.exe"),
+                        input=generator_args,
+                        timeout=15
+                    )
 
             if execution:
                 sudoku_gen = load_sudoku_board(file_path=os.path.join("src", "Tmp", "sudoku-gen.txt"))
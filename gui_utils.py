@@ -33,6 +33,26 @@ def call_exe(file_name: str, input: list, timeout: int=60, retries=5) -> bool:
             return False
 
 
+def spawn_exe(file_name: str, input: list) -> None:
+    """
+    Start an executable in the background, without waiting for it to finish.
+
+    :param file_name: name of the executable
+    :param input: arguments
+    :return: None
+    """
+
+    system = platform.system().lower()
+    file_name = file_name.rsplit('.', 1)[0] if '.exe' in file_name else file_name
+    command = ["wine64", file_name] if system != "windows" else [file_name]
+    command.extend(input)
+
+    try:
+        subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    except Exception:
+        pass
+
+
 def check_valid_sudoku(sudoku: np.ndarray) -> bool:
     """
     Check if the current sudoku puzzle is valid.
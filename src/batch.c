@@ -0,0 +1,919 @@
+#include "batch.h"
+#include "helpers.h"
+#include "io.h"
+#include "queue.h"
+#include "solver_bitmask.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BATCH_BLOCK_SIZE 16
+#define BATCH_BLOCKS_PER_THREAD 8
+#define PIPELINE_QUEUE_SIZE 1024
+#define PIPELINE_OUTPUT_SIZE (1 << 16)
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- BATCH SOLVER --- //
+
+
+/**
+ * Function: solve_record
+ * ----------------------
+ * Solves or counts a parsed puzzle and formats the matching output line:
+ * - the first solution as 81 digits (BATCH_SOLVE), or the number of solutions, at most N_SOL (BATCH_COUNT);
+ * - "error: line <n>: invalid puzzle" (or "error: record <n>: ..." for packed input), "error: conflicting givens"
+ *   or "error: no solution" otherwise.
+ *
+ * Parameters:
+ * - sudoku: The puzzle.
+ * - parsed: Whether the record held a well-formed puzzle.
+ * - unit: What `number` counts, "line" or "record".
+ * - number: Line (or packed record) number of the puzzle in the input, from 1.
+ * - mode: What to compute.
+ * - result: Buffer of BATCH_LINE_SIZE characters receiving the output line, newline included.
+ * - summary: Totals updated with the outcome.
+ *
+ * Returns:
+ * - The length of the output line.
+ */
+static size_t solve_record(
+    Sudoku *sudoku,
+    bool parsed,
+    const char *unit,
+    long number,
+    BatchMode mode,
+    char *result,
+    BatchSummary *summary
+) {
+    TRACE_SCOPE("solve_puzzle");
+    summary->puzzles++;
+    if(!parsed) {
+        summary->invalid++;
+        return snprintf(result, BATCH_LINE_SIZE, "error: %s %ld: invalid puzzle\n", unit, number);
+    }
+    if(!is_consistent(sudoku)) {
+        summary->invalid++;
+        return snprintf(result, BATCH_LINE_SIZE, "error: conflicting givens\n");
+    }
+
+    Sudoku solutions[N_SOL];
+    int n_solutions = find_solutions(sudoku, (mode == BATCH_SOLVE) ? solutions : NULL, time(NULL));
+    if(n_solutions == 0) {
+        summary->unsolvable++;
+        if(mode == BATCH_SOLVE) {
+            return snprintf(result, BATCH_LINE_SIZE, "error: no solution\n");
+        }
+    }
+    if(mode == BATCH_COUNT) {
+        return snprintf(result, BATCH_LINE_SIZE, "%d\n", n_solutions);
+    }
+
+    return format_sudoku(&solutions[0], FORMAT_LINE, result);
+}
+
+
+/**
+ * Function: solve_line
+ * --------------------
+ * Solves or counts the puzzle held by one input line (see `solve_record`).
+ * Blank lines and lines starting with '#' produce no output.
+ *
+ * Parameters:
+ * - line: The input line, NUL-terminated.
+ * - number: Line number of the input line, from 1.
+ * - mode: What to compute.
+ * - result: Buffer of BATCH_LINE_SIZE characters receiving the output line, newline included.
+ * - summary: Totals updated with the outcome.
+ *
+ * Returns:
+ * - The length of the output line (0 if the line was skipped).
+ */
+size_t solve_line(
+    const char *line,
+    long number,
+    BatchMode mode,
+    char *result,
+    BatchSummary *summary
+) {
+    if(line[0] == '\n' || line[0] == '\r' || line[0] == '\0' || line[0] == '#') {
+        return 0;
+    }
+    Sudoku sudoku;
+    bool parsed = parse_line(&sudoku, line);
+    return solve_record(&sudoku, parsed, "line", number, mode, result, summary);
+}
+
+
+/**
+ * Function: solve_range
+ * ---------------------
+ * Solves or counts the puzzles of a range of mapped lines, parsed in place (see `solve_record`),
+ * or of a range of packed records.
+ *
+ * Parameters:
+ * - range: The lines or records to process.
+ * - packed: Whether the range holds packed records.
+ * - mode: What to compute.
+ * - output: Buffer receiving the output lines, at least BATCH_LINE_SIZE characters per line of the range.
+ * - summary: Totals updated with the outcome.
+ *
+ * Returns:
+ * - The length of the output.
+ */
+static size_t solve_range(
+    LineRange range,
+    bool packed,
+    BatchMode mode,
+    char *output,
+    BatchSummary *summary
+) {
+    Sudoku sudoku;
+    RecordStatus status;
+    long line;
+    size_t length = 0;
+    const char *unit = packed ? "record" : "line";
+    while(true) {
+        status = packed ? next_packed(&range, &sudoku, &line) : next_record(&range, &sudoku, &line);
+        if(status == RECORD_END) break;
+        length += solve_record(&sudoku, status == RECORD_PUZZLE, unit, line, mode, output + length, summary);
+    }
+    return length;
+}
+
+
+/**
+ * Function: read_line
+ * -------------------
+ * Reads the next line of a stream, discarding the part beyond `size` characters.
+ *
+ * Returns:
+ * - true if a line was read,
+ *   false at the end of the stream.
+ */
+static bool read_line(FILE *in, char *line, int size) {
+    if(fgets(line, size, in) == NULL) {
+        return false;
+    }
+    if(strchr(line, '\n') == NULL) {
+        int ch;
+        while((ch = getc(in)) != EOF && ch != '\n');
+    }
+    return true;
+}
+
+
+// A stream of puzzles: lines in the one-line format, or the records of a packed file (see io.c)
+typedef struct {
+    FILE *file;
+    bool packed;
+    char start[4];      // Start of the first line, read while looking for the packed header
+    int n_start;
+    long number;        // Number of the last line or record read, from 1
+} BatchInput;
+
+
+/**
+ * Function: open_input
+ * --------------------
+ * Tells a packed stream from a stream of lines by its first bytes. They are read one at a time and only
+ * while they match the packed header, so nothing is lost on a stream of lines: the bytes read are handed
+ * back with the first line by `read_input`.
+ *
+ * Parameters:
+ * - input: Pointer to the BatchInput structure to set up.
+ * - file: Stream of puzzles.
+ *
+ * Returns:
+ * - true if the stream holds lines, or packed records of the supported version,
+ *   false if it holds packed records of another version (reported on stderr).
+ */
+static bool open_input(BatchInput *input, FILE *file) {
+    input->file = file;
+    input->packed = false;
+    input->n_start = 0;
+    input->number = 0;
+
+    int ch = EOF;
+    while(input->n_start < 4 && (ch = getc(file)) == PACKED_MAGIC[input->n_start]) {
+        input->start[input->n_start++] = (char)ch;
+    }
+    if(input->n_start < 4) {
+        if(ch != EOF) ungetc(ch, file);
+        return true;
+    }
+
+    uint32_t version, record_size;
+    input->packed = true;
+    input->n_start = 0;
+    if(fread(&version, sizeof(version), 1, file) != 1 || version != PACKED_VERSION
+        || fread(&record_size, sizeof(record_size), 1, file) != 1 || record_size != PACKED_RECORD_SIZE) {
+        fprintf(stderr, "error: unsupported packed puzzle format\n");
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Function: read_input
+ * --------------------
+ * Reads the next line of a stream of lines (see `read_line`), or the next record of a packed stream.
+ *
+ * Parameters:
+ * - input: Pointer to the BatchInput structure.
+ * - line: Buffer of BATCH_LINE_SIZE characters receiving the line or the record.
+ *
+ * Returns:
+ * - true if a line or a record was read,
+ *   false at the end of the stream (a truncated last record is ignored).
+ */
+static bool read_input(BatchInput *input, char *line) {
+    bool read;
+    if(input->packed) {
+        read = fread(line, PACKED_RECORD_SIZE, 1, input->file) == 1;
+    } else if(input->n_start > 0) {
+        // The first line goes on after the bytes already read, if it does at all
+        memcpy(line, input->start, input->n_start);
+        if(!read_line(input->file, line + input->n_start, BATCH_LINE_SIZE - input->n_start)) {
+            line[input->n_start] = '\0';
+        }
+        input->n_start = 0;
+        read = true;
+    } else {
+        read = read_line(input->file, line, BATCH_LINE_SIZE);
+    }
+    if(read) {
+        input->number++;
+    }
+    return read;
+}
+
+
+/**
+ * Function: solve_input
+ * ---------------------
+ * Solves or counts the puzzle of a line or a packed record read by `read_input` (see `solve_line`).
+ *
+ * Parameters:
+ * - line: The line, NUL-terminated, or the record.
+ * - packed: Whether `line` holds a packed record.
+ * - number: Number of the line or the record, from 1.
+ * - mode: What to compute.
+ * - result: Buffer of BATCH_LINE_SIZE characters receiving the output line, newline included.
+ * - summary: Totals updated with the outcome.
+ *
+ * Returns:
+ * - The length of the output line (0 if the line was skipped).
+ */
+static size_t solve_input(
+    const char *line,
+    bool packed,
+    long number,
+    BatchMode mode,
+    char *result,
+    BatchSummary *summary
+) {
+    if(!packed) {
+        return solve_line(line, number, mode, result, summary);
+    }
+    Sudoku sudoku;
+    bool parsed = unpack_puzzle(&sudoku, (const unsigned char *)line);
+    return solve_record(&sudoku, parsed, "record", number, mode, result, summary);
+}
+
+
+/**
+ * Function: solve_lines
+ * ---------------------
+ * Sequential counterpart of `solve_batch` for a range of mapped lines, parsed in place, or of packed records.
+ *
+ * Parameters:
+ * - range: The lines or records to process.
+ * - packed: Whether the range holds packed records.
+ * - out: Stream receiving the results.
+ * - mode: What to compute for each puzzle.
+ *
+ * Returns:
+ * - The totals of the run.
+ */
+static BatchSummary solve_lines(
+    LineRange range,
+    bool packed,
+    FILE *out,
+    BatchMode mode
+) {
+    BatchSummary summary = {0};
+    char result[BATCH_LINE_SIZE];
+    LineRange line;
+    while(packed ? split_records(&range, 1, &line) : split_lines(&range, 1, &line)) {
+        size_t length = solve_range(line, packed, mode, result, &summary);
+        if(length > 0) {
+            fwrite(result, 1, length, out);
+        }
+    }
+    fflush(out);
+    return summary;
+}
+
+
+/**
+ * Function: solve_batch
+ * ---------------------
+ * Streams puzzles in the one-line format from `in` and writes one result line per puzzle to `out`
+ * (see `solve_line`), in input order. Only one line is held in memory at a time, so arbitrarily
+ * large corpora can be processed; the part of a line beyond BATCH_LINE_SIZE characters is discarded.
+ * Packed streams are recognized by their header and read record by record (see `open_input`).
+ *
+ * Parameters:
+ * - in: Stream of puzzles.
+ * - out: Stream receiving the results.
+ * - mode: What to compute for each puzzle.
+ *
+ * Returns:
+ * - The totals of the run.
+ */
+BatchSummary solve_batch(
+    FILE *in,
+    FILE *out,
+    BatchMode mode
+) {
+    BatchSummary summary = {0};
+    char line[BATCH_LINE_SIZE];
+    char result[BATCH_LINE_SIZE];
+    BatchInput input;
+    if(!open_input(&input, in)) {
+        return summary;
+    }
+
+    while(read_input(&input, line)) {
+        size_t length = solve_input(line, input.packed, input.number, mode, result, &summary);
+        if(length > 0) {
+            fwrite(result, 1, length, out);
+        }
+    }
+    fflush(out);
+    return summary;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- PARALLEL BATCH SOLVER --- //
+
+
+typedef struct ParallelBatch ParallelBatch;
+
+// A block of consecutive input lines (or packed records), solved as one task: copied from a stream, or a range of a mapped file
+typedef struct {
+    ParallelBatch *batch;
+    char lines[BATCH_BLOCK_SIZE][BATCH_LINE_SIZE];
+    int n_lines;
+    long first_line;
+    LineRange range;
+    char output[BATCH_BLOCK_SIZE * BATCH_LINE_SIZE];
+    size_t length;
+    bool done;
+} BatchBlock;
+
+struct ParallelBatch {
+    FILE *out;
+    BatchMode mode;
+    bool ordered;
+    bool mapped;
+    bool packed;
+
+    // Blocks in flight: a ring indexed by block number when ordered, a free list otherwise
+    BatchBlock *blocks;
+    int n_blocks;
+    int *free_blocks;
+    int n_free;
+
+    BatchSummary summary;
+    pthread_mutex_t lock;
+    pthread_cond_t block_done;
+};
+
+
+/**
+ * Function: solve_block
+ * ---------------------
+ * Task solving the lines of a block. The results are written right away when the order does not matter,
+ * otherwise the block is marked as done and left for `solve_batch_parallel` to write in order.
+ *
+ * Parameters:
+ * - arg: Pointer to the BatchBlock structure.
+ */
+static void solve_block(void *arg) {
+    BatchBlock *block = arg;
+    ParallelBatch *batch = block->batch;
+    BatchSummary summary = {0};
+
+    block->length = 0;
+    if(batch->mapped) {
+        block->length = solve_range(block->range, batch->packed, batch->mode, block->output, &summary);
+    }
+    for(int i = 0; i < block->n_lines; i++) {
+        block->length += solve_input(block->lines[i], batch->packed, block->first_line + i, batch->mode,
+                                     block->output + block->length, &summary);
+    }
+
+    pthread_mutex_lock(&batch->lock);
+    batch->summary.puzzles += summary.puzzles;
+    batch->summary.invalid += summary.invalid;
+    batch->summary.unsolvable += summary.unsolvable;
+    if(!batch->ordered) {
+        fwrite(block->output, 1, block->length, batch->out);
+        batch->free_blocks[batch->n_free++] = (int)(block - batch->blocks);
+    }
+    block->done = true;
+    pthread_cond_broadcast(&batch->block_done);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+
+/**
+ * Function: write_block
+ * ---------------------
+ * Writes the results of a block once it is solved (ordered mode).
+ *
+ * Parameters:
+ * - batch: Pointer to the ParallelBatch structure.
+ * - block: The block to write.
+ * - wait: Whether to wait for the block to be solved.
+ *
+ * Returns:
+ * - true if the block was written,
+ *   false if it is not solved yet and `wait` is not set.
+ */
+static bool write_block(ParallelBatch *batch, BatchBlock *block, bool wait) {
+    pthread_mutex_lock(&batch->lock);
+    while(wait && !block->done) {
+        pthread_cond_wait(&batch->block_done, &batch->lock);
+    }
+    bool done = block->done;
+    pthread_mutex_unlock(&batch->lock);
+    if(done) {
+        fwrite(block->output, 1, block->length, batch->out);
+    }
+    return done;
+}
+
+
+/**
+ * Function: run_parallel
+ * ----------------------
+ * Spreads the puzzles of a stream, or of a range of mapped lines, over the workers of a thread pool.
+ * Lines are taken in blocks of BATCH_BLOCK_SIZE, each solved as one task; the pool balances them through
+ * work stealing, so a block of hard puzzles only keeps its own worker busy.
+ * Stream lines are copied into the block, mapped lines are only split off and parsed in place by the workers.
+ * At most BATCH_BLOCKS_PER_THREAD blocks per worker are in flight, which bounds the memory used.
+ * When `ordered` is set the results keep the input order: the blocks form a reorder buffer and are
+ * written as soon as all the preceding ones are; otherwise each block is written as soon as it is solved.
+ *
+ * Parameters:
+ * - in: Stream of puzzles (lines or packed records, see `open_input`), or NULL to read from `range`.
+ * - range: Mapped lines to process, when `in` is NULL.
+ * - packed: Whether `range` holds packed records instead of lines.
+ * - out: Stream receiving the results.
+ * - mode: What to compute for each puzzle.
+ * - n_threads: Number of workers.
+ * - ordered: Whether the results must follow the input order.
+ *
+ * Returns:
+ * - The totals of the run.
+ */
+static BatchSummary run_parallel(
+    FILE *in,
+    LineRange range,
+    bool packed,
+    FILE *out,
+    BatchMode mode,
+    int n_threads,
+    bool ordered
+) {
+    ThreadPool *pool = thread_pool_create(n_threads);
+    ParallelBatch batch = {0};
+    batch.n_blocks = BATCH_BLOCKS_PER_THREAD * ((n_threads > 0) ? n_threads : 1);
+    batch.blocks = malloc(batch.n_blocks * sizeof(BatchBlock));
+    batch.free_blocks = malloc(batch.n_blocks * sizeof(int));
+    if(pool == NULL || batch.blocks == NULL || batch.free_blocks == NULL) {
+        thread_pool_destroy(pool);
+        free(batch.blocks);
+        free(batch.free_blocks);
+        return (in != NULL) ? solve_batch(in, out, mode) : solve_lines(range, packed, out, mode);
+    }
+    BatchInput input;
+    if(in != NULL && !open_input(&input, in)) {
+        thread_pool_destroy(pool);
+        free(batch.blocks);
+        free(batch.free_blocks);
+        return batch.summary;
+    }
+    batch.out = out;
+    batch.mode = mode;
+    batch.ordered = ordered;
+    batch.mapped = (in == NULL);
+    batch.packed = batch.mapped ? packed : input.packed;
+    for(int i = 0; i < batch.n_blocks; i++) {
+        batch.free_blocks[batch.n_free++] = batch.n_blocks - 1 - i;
+    }
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.block_done, NULL);
+
+    long n_read = 0, n_written = 0;
+    bool more = true;
+    while(more) {
+        // Take a block: the next one of the ring once written, or any free one
+        BatchBlock *block;
+        if(ordered) {
+            while(n_written < n_read && write_block(&batch, &batch.blocks[n_written % batch.n_blocks], false)) {
+                n_written++;
+            }
+            block = &batch.blocks[n_read % batch.n_blocks];
+            if(n_read - n_written == batch.n_blocks) {
+                write_block(&batch, block, true);
+                n_written++;
+            }
+        } else {
+            pthread_mutex_lock(&batch.lock);
+            while(batch.n_free == 0) {
+                pthread_cond_wait(&batch.block_done, &batch.lock);
+            }
+            block = &batch.blocks[batch.free_blocks[--batch.n_free]];
+            pthread_mutex_unlock(&batch.lock);
+        }
+
+        block->batch = &batch;
+        block->n_lines = 0;
+        block->done = false;
+        bool empty;
+        if(batch.mapped) {
+            empty = packed ? !split_records(&range, BATCH_BLOCK_SIZE, &block->range)
+                           : !split_lines(&range, BATCH_BLOCK_SIZE, &block->range);
+            more = !empty;
+        } else {
+            block->first_line = input.number + 1;
+            while(block->n_lines < BATCH_BLOCK_SIZE && (more = read_input(&input, block->lines[block->n_lines]))) {
+                block->n_lines++;
+            }
+            empty = (block->n_lines == 0);
+        }
+        if(empty) {
+            if(!ordered) {
+                pthread_mutex_lock(&batch.lock);
+                batch.free_blocks[batch.n_free++] = (int)(block - batch.blocks);
+                pthread_mutex_unlock(&batch.lock);
+            }
+            break;
+        }
+        thread_pool_submit(pool, solve_block, block);
+        n_read++;
+    }
+
+    while(ordered && n_written < n_read) {
+        write_block(&batch, &batch.blocks[n_written % batch.n_blocks], true);
+        n_written++;
+    }
+    thread_pool_wait(pool);
+    thread_pool_destroy(pool);
+    fflush(out);
+
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.block_done);
+    free(batch.blocks);
+    free(batch.free_blocks);
+    return batch.summary;
+}
+
+
+/**
+ * Function: solve_batch_parallel
+ * ------------------------------
+ * Same as `solve_batch`, spreading the puzzles over the workers of a thread pool (see `run_parallel`).
+ *
+ * Parameters:
+ * - in: Stream of puzzles.
+ * - out: Stream receiving the results.
+ * - mode: What to compute for each puzzle.
+ * - n_threads: Number of workers.
+ * - ordered: Whether the results must follow the input order.
+ *
+ * Returns:
+ * - The totals of the run.
+ */
+BatchSummary solve_batch_parallel(
+    FILE *in,
+    FILE *out,
+    BatchMode mode,
+    int n_threads,
+    bool ordered
+) {
+    LineRange none = {0};
+    return run_parallel(in, none, false, out, mode, n_threads, ordered);
+}
+
+
+/**
+ * Function: solve_batch_mapped
+ * ----------------------------
+ * Same as `solve_batch_parallel` for a mapped file: the puzzles are parsed in place by the workers,
+ * without copying the lines or issuing a system call per puzzle.
+ * Packed puzzle files (see io.c) are recognized by their header and unpacked in place the same way.
+ *
+ * Parameters:
+ * - file: The mapped file of puzzles.
+ * - out: Stream receiving the results.
+ * - mode: What to compute for each puzzle.
+ * - n_threads: Number of workers.
+ * - ordered: Whether the results must follow the input order.
+ *
+ * Returns:
+ * - The totals of the run.
+ */
+BatchSummary solve_batch_mapped(
+    const MappedFile *file,
+    FILE *out,
+    BatchMode mode,
+    int n_threads,
+    bool ordered
+) {
+    LineRange range;
+    bool packed = packed_records(file, &range);
+    if(!packed) {
+        range = mapped_lines(file);
+    }
+    if(n_threads <= 1) {
+        return solve_lines(range, packed, out, mode);
+    }
+    return run_parallel(NULL, range, packed, out, mode, n_threads, ordered);
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- PIPELINE --- //
+
+
+// A parsed puzzle, from the parser to the solvers
+typedef struct {
+    long index;
+    long line;
+    bool parsed;
+    Sudoku sudoku;
+} PipelineInput;
+
+// A result line, from the solvers to the writer
+typedef struct {
+    long index;
+    size_t length;
+    char text[BATCH_LINE_SIZE];
+} PipelineOutput;
+
+typedef struct {
+    BatchInput in;
+    FILE *out;
+    BatchMode mode;
+    bool ordered;
+    BoundedQueue *inputs;
+    BoundedQueue *outputs;
+
+    // Number of puzzles (-1 until the input ends), and of results written so far
+    atomic_long n_total;
+    atomic_long n_written;
+
+    // Reorder ring of the writer, and its output buffer
+    long window;
+    PipelineOutput *ring;
+    bool *ready;
+    char *buffer;
+} Pipeline;
+
+typedef struct {
+    Pipeline *pipeline;
+    BatchSummary summary;
+} PipelineSolver;
+
+
+/**
+ * Function: pipeline_parser
+ * -------------------------
+ * Parser thread: reads and parses the input lines (or unpacks the records) and queues the puzzles for the solvers.
+ * It never gets more than `window` puzzles ahead of the writer, which keeps the memory constant.
+ *
+ * Parameters:
+ * - arg: Pointer to the Pipeline structure.
+ */
+static void *pipeline_parser(void *arg) {
+    Pipeline *pipeline = arg;
+    BatchInput *in = &pipeline->in;
+    char line[BATCH_LINE_SIZE];
+    long index = 0;
+
+    while(read_input(in, line)) {
+        if(!in->packed && (line[0] == '\n' || line[0] == '\r' || line[0] == '\0' || line[0] == '#')) {
+            continue;
+        }
+        PipelineInput input;
+        input.index = index;
+        input.line = in->number;
+        input.parsed = in->packed ? unpack_puzzle(&input.sudoku, (const unsigned char *)line)
+                                  : parse_line(&input.sudoku, line);
+
+        int attempt = 0;
+        while(index - atomic_load(&pipeline->n_written) >= pipeline->window) {
+            queue_backoff(&attempt);
+        }
+        queue_push(pipeline->inputs, &input);
+        index++;
+    }
+    atomic_store(&pipeline->n_total, index);
+    return NULL;
+}
+
+
+/**
+ * Function: pipeline_solver
+ * -------------------------
+ * Solver thread: takes the parsed puzzles, solves them (see `solve_record`) and queues the results for the writer,
+ * until the input has ended and every puzzle has been taken.
+ *
+ * Parameters:
+ * - arg: Pointer to the PipelineSolver structure, also collecting the totals of the thread.
+ */
+static void *pipeline_solver(void *arg) {
+    PipelineSolver *solver = arg;
+    Pipeline *pipeline = solver->pipeline;
+    const char *unit = pipeline->in.packed ? "record" : "line";
+    PipelineInput input;
+    PipelineOutput output;
+    int attempt = 0;
+
+    while(true) {
+        if(!queue_try_pop(pipeline->inputs, &input)) {
+            // Checked before a last attempt, so a puzzle queued just before the end is not missed
+            bool ended = atomic_load(&pipeline->n_total) >= 0;
+            if(ended && !queue_try_pop(pipeline->inputs, &input)) {
+                return NULL;
+            }
+            if(!ended) {
+                queue_backoff(&attempt);
+                continue;
+            }
+        }
+        attempt = 0;
+        output.index = input.index;
+        output.length = solve_record(&input.sudoku, input.parsed, unit, input.line, pipeline->mode, output.text, &solver->summary);
+        queue_push(pipeline->outputs, &output);
+    }
+}
+
+
+/**
+ * Function: pipeline_writer
+ * -------------------------
+ * Writer thread: takes the results and writes them in large blocks. When the order matters, results that
+ * arrive early wait in a reorder ring of `window` slots, which the parser never lets overflow.
+ *
+ * Parameters:
+ * - arg: Pointer to the Pipeline structure.
+ */
+static void *pipeline_writer(void *arg) {
+    Pipeline *pipeline = arg;
+    PipelineOutput *ring = pipeline->ring;
+    bool *ready = pipeline->ready;
+    char *buffer = pipeline->buffer;
+    size_t length = 0;
+    long n_written = 0;
+    int attempt = 0;
+
+    PipelineOutput output;
+    while(true) {
+        long n_total = atomic_load(&pipeline->n_total);
+        if(n_total >= 0 && n_written == n_total) {
+            break;
+        }
+        if(!queue_try_pop(pipeline->outputs, &output)) {
+            // Nothing to do for a while: write what is buffered rather than hold it back
+            if(length > 0 && attempt >= 16) {
+                fwrite(buffer, 1, length, pipeline->out);
+                fflush(pipeline->out);
+                length = 0;
+            }
+            queue_backoff(&attempt);
+            continue;
+        }
+        attempt = 0;
+
+        PipelineOutput *next = &output;
+        if(pipeline->ordered) {
+            ring[output.index % pipeline->window] = output;
+            ready[output.index % pipeline->window] = true;
+            next = &ring[n_written % pipeline->window];
+            if(!ready[n_written % pipeline->window]) {
+                continue;
+            }
+        }
+
+        // Write every result that is now in order (just the one taken when the order does not matter)
+        do {
+            if(PIPELINE_OUTPUT_SIZE - length < BATCH_LINE_SIZE) {
+                fwrite(buffer, 1, length, pipeline->out);
+                length = 0;
+            }
+            memcpy(buffer + length, next->text, next->length);
+            length += next->length;
+            if(pipeline->ordered) {
+                ready[n_written % pipeline->window] = false;
+            }
+            atomic_store(&pipeline->n_written, ++n_written);
+            next = pipeline->ordered ? &ring[n_written % pipeline->window] : NULL;
+        } while(next != NULL && ready[n_written % pipeline->window]);
+    }
+
+    fwrite(buffer, 1, length, pipeline->out);
+    fflush(pipeline->out);
+    return NULL;
+}
+
+
+/**
+ * Function: solve_batch_pipeline
+ * ------------------------------
+ * Same as `solve_batch_parallel`, as a three-stage pipeline: a parser thread feeds the parsed puzzles to
+ * `n_threads` solver threads through a lock-free bounded queue, and a writer thread collects the results
+ * from a second queue. Reading, solving and writing all overlap, and since the queues are bounded and the
+ * parser waits when it gets too far ahead of the writer, the memory used does not depend on the input size.
+ *
+ * Parameters:
+ * - in: Stream of puzzles.
+ * - out: Stream receiving the results.
+ * - mode: What to compute for each puzzle.
+ * - n_threads: Number of solver threads.
+ * - ordered: Whether the results must follow the input order.
+ *
+ * Returns:
+ * - The totals of the run.
+ */
+BatchSummary solve_batch_pipeline(
+    FILE *in,
+    FILE *out,
+    BatchMode mode,
+    int n_threads,
+    bool ordered
+) {
+    if(n_threads < 1) n_threads = 1;
+
+    Pipeline pipeline = {
+        .out = out,
+        .mode = mode,
+        .ordered = ordered,
+        .inputs = queue_create(PIPELINE_QUEUE_SIZE, sizeof(PipelineInput)),
+        .outputs = queue_create(PIPELINE_QUEUE_SIZE, sizeof(PipelineOutput)),
+        .window = 4 * PIPELINE_QUEUE_SIZE
+    };
+    pipeline.ring = malloc(pipeline.window * sizeof(PipelineOutput));
+    pipeline.ready = calloc(pipeline.window, sizeof(bool));
+    pipeline.buffer = malloc(PIPELINE_OUTPUT_SIZE);
+    atomic_init(&pipeline.n_total, -1);
+    atomic_init(&pipeline.n_written, 0);
+    PipelineSolver *solvers = calloc(n_threads, sizeof(PipelineSolver));
+    pthread_t *solver_threads = malloc(n_threads * sizeof(pthread_t));
+    bool allocated = pipeline.inputs != NULL && pipeline.outputs != NULL && pipeline.ring != NULL
+        && pipeline.ready != NULL && pipeline.buffer != NULL && solvers != NULL && solver_threads != NULL;
+    BatchSummary summary = {0};
+    if(!allocated) {
+        summary = solve_batch(in, out, mode);
+    } else if(open_input(&pipeline.in, in)) {
+        pthread_t parser, writer;
+        pthread_create(&parser, NULL, pipeline_parser, &pipeline);
+        pthread_create(&writer, NULL, pipeline_writer, &pipeline);
+        for(int i = 0; i < n_threads; i++) {
+            solvers[i].pipeline = &pipeline;
+            pthread_create(&solver_threads[i], NULL, pipeline_solver, &solvers[i]);
+        }
+
+        pthread_join(parser, NULL);
+        for(int i = 0; i < n_threads; i++) {
+            pthread_join(solver_threads[i], NULL);
+            summary.puzzles += solvers[i].summary.puzzles;
+            summary.invalid += solvers[i].summary.invalid;
+            summary.unsolvable += solvers[i].summary.unsolvable;
+        }
+        pthread_join(writer, NULL);
+    }
+
+    queue_destroy(pipeline.inputs);
+    queue_destroy(pipeline.outputs);
+    free(pipeline.ring);
+    free(pipeline.ready);
+    free(pipeline.buffer);
+    free(solvers);
+    free(solver_threads);
+    return summary;
+}
@@ -0,0 +1,42 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "io.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define BATCH_LINE_SIZE 128
+
+/**
+ * Type: BatchMode
+ * ---------------
+ * What is written for each puzzle of a batch: its first solution, or its number of solutions.
+ */
+typedef enum {
+    BATCH_SOLVE,
+    BATCH_COUNT
+} BatchMode;
+
+/**
+ * Type: BatchSummary
+ * ------------------
+ * Totals of a batch run.
+ */
+typedef struct {
+    long puzzles;
+    long invalid;
+    long unsolvable;
+} BatchSummary;
+
+size_t solve_line(const char *line, long number, BatchMode mode, char *result, BatchSummary *summary);
+
+BatchSummary solve_batch(FILE *in, FILE *out, BatchMode mode);
+
+BatchSummary solve_batch_parallel(FILE *in, FILE *out, BatchMode mode, int n_threads, bool ordered);
+
+BatchSummary solve_batch_pipeline(FILE *in, FILE *out, BatchMode mode, int n_threads, bool ordered);
+
+BatchSummary solve_batch_mapped(const MappedFile *file, FILE *out, BatchMode mode, int n_threads, bool ordered);
+
+#endif
@@ -0,0 +1,607 @@
+#include "generator.h"
+#include "io.h"
+#include "rng.h"
+#include "seed_bank.h"
+#include "solver_backtrack.h"
+#include "solver_bitmask.h"
+#include "solver_human.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no extra library
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#define DEFAULT_GENERATED 4
+#define DEFAULT_SEED 1
+#define DEFAULT_REPEAT 5
+#define STATES_PER_PUZZLE 512
+
+
+/******************************************************************************
+ * Benchmark report
+ * One JSON object per line, for each engine and corpus it ran on:
+ *
+ *   {"engine":"bitmask","corpus":"corpus.txt","puzzles":200,"seconds":0.012,
+ *    "puzzles_per_second":16000.0,"median_us":45.1,"p90_us":98.0,"p99_us":210.4,
+ *    "max_us":402.9,"nodes_per_puzzle":61.3,"peak_rss_kb":2048}
+ *
+ * Engines: "backtrack" (solver_backtrack.c, up to N_SOL solutions), "bitmask"
+ * (solver_bitmask.c, up to N_SOL solutions), "human" (solver_human.c) and
+ * "generator" (generate_puzzle, one corpus per level, named "level1"...).
+ * Latencies are per puzzle. Nodes are the search steps of the bitmask search
+ * and the technique applications of the human solver. For the backtracking
+ * search and the generator they are only counted in builds with the search
+ * counters (`make COUNTERS=1`, which slows every engine down), and null
+ * otherwise. The peak resident memory is the one of the whole process so far.
+ *
+ * With --techniques, one line per technique of the human solver instead:
+ *
+ *   {"technique":"naked_pair","states":11180,"calls":55900,"ns_per_call":850.2,
+ *    "hit_rate":0.0412,"solver_calls":1830,"solver_ms":1.556}
+ *
+ * The states are snapshots of the human solves of the corpora, taken at the
+ * start of every round. Each technique runs in isolation on every state
+ * (`calls` in total, the cost of copying the state is subtracted) and
+ * `hit_rate` is the fraction of the calls that made progress. `solver_calls`
+ * is the number of states on which the solver reaches the technique, since it
+ * only tries a technique when the simpler ones fail, and `solver_ms` estimates
+ * the time spent in the technique on those states (solver_calls * ns_per_call).
+ ******************************************************************************/
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- MEASUREMENTS --- //
+
+
+typedef struct {
+    const char *name;
+    Sudoku *puzzles;
+    int count;
+} Corpus;
+
+// Runs an engine on a puzzle and returns the number of nodes visited, or -1 if the engine does not count them
+typedef long (*Engine)(Sudoku *sudoku);
+
+typedef struct {
+    double *latencies;
+    int count;
+    long nodes;
+    bool has_nodes;
+    double seconds;
+} Measurement;
+
+
+/**
+ * Function: bench_clock
+ * ---------------------
+ * Returns a monotonic time in seconds, with sub-microsecond resolution.
+ */
+static double bench_clock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+
+/**
+ * Function: peak_memory_kb
+ * ------------------------
+ * Returns the peak resident memory of the process in KiB, or -1 if it is not available.
+ */
+static long peak_memory_kb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return (long)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss;
+#endif
+}
+
+
+/**
+ * Function: compare_latencies
+ * ---------------------------
+ * Orders two latencies increasingly, for qsort.
+ */
+static int compare_latencies(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * Function: percentile
+ * --------------------
+ * Returns a percentile of sorted latencies (nearest rank), in microseconds.
+ *
+ * Parameters:
+ * - sorted: Latencies in seconds, in increasing order.
+ * - count: Number of latencies (at least 1).
+ * - fraction: The percentile, between 0 and 1.
+ */
+static double percentile(const double *sorted, int count, double fraction) {
+    int rank = (int)(fraction * count + 0.999999);
+    if(rank < 1) rank = 1;
+    if(rank > count) rank = count;
+    return sorted[rank - 1] * 1e6;
+}
+
+
+/**
+ * Function: report
+ * ----------------
+ * Prints the JSON line of a measurement (see the format above).
+ *
+ * Parameters:
+ * - engine: Name of the engine.
+ * - corpus: Name of the corpus.
+ * - measurement: Pointer to the Measurement structure; its latencies are sorted in place.
+ */
+static void report(const char *engine, const char *corpus, Measurement *measurement) {
+    int count = measurement->count;
+    printf("{\"engine\":\"%s\",\"corpus\":\"%s\",\"puzzles\":%d,\"seconds\":%.6f", engine, corpus, count, measurement->seconds);
+    if(count == 0) {
+        printf(",\"puzzles_per_second\":0,\"median_us\":null,\"p90_us\":null,\"p99_us\":null,\"max_us\":null");
+    } else {
+        qsort(measurement->latencies, count, sizeof(double), compare_latencies);
+        printf(",\"puzzles_per_second\":%.1f,\"median_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f",
+               measurement->seconds > 0 ? count / measurement->seconds : 0.0,
+               percentile(measurement->latencies, count, 0.5),
+               percentile(measurement->latencies, count, 0.9),
+               percentile(measurement->latencies, count, 0.99),
+               measurement->latencies[count - 1] * 1e6);
+    }
+    if(measurement->has_nodes && count > 0) {
+        printf(",\"nodes_per_puzzle\":%.1f", (double)measurement->nodes / count);
+    } else {
+        printf(",\"nodes_per_puzzle\":null");
+    }
+    printf(",\"peak_rss_kb\":%ld}\n", peak_memory_kb());
+    fflush(stdout);
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- ENGINES --- //
+
+
+static long run_backtrack(Sudoku *sudoku) {
+    Sudoku solutions[N_SOL];
+    int n_solutions = 0;
+#ifdef SOLVER_COUNTERS
+    SolverStats stats = {0};
+    counters_attach(&stats);
+    solve_sudoku(sudoku, solutions, N_SOL, &n_solutions);
+    counters_attach(NULL);
+    return stats.counters.nodes;
+#else
+    solve_sudoku(sudoku, solutions, N_SOL, &n_solutions);
+    return -1;
+#endif
+}
+
+
+static long run_bitmask(Sudoku *sudoku) {
+    Sudoku solutions[N_SOL];
+    long nodes = 0;
+    search_solutions(sudoku, solutions, time(NULL), &nodes);
+    return nodes;
+}
+
+
+static long run_human(Sudoku *sudoku) {
+    SolverStats stats = {0};
+    solve_human_log(sudoku, &stats, NULL);
+    return (long)stats.naked_single + stats.hidden_single + stats.naked_pair + stats.hidden_pair + stats.pointing_pair
+         + stats.naked_triple + stats.hidden_triple + stats.pointing_triple + stats.x_wing;
+}
+
+
+/**
+ * Function: bench_solver
+ * ----------------------
+ * Runs a solving engine once on every puzzle of a corpus and reports the measurement.
+ *
+ * Parameters:
+ * - name: Name of the engine.
+ * - engine: The engine.
+ * - corpus: Pointer to the Corpus structure.
+ */
+static void bench_solver(const char *name, Engine engine, const Corpus *corpus) {
+    Measurement measurement = {0};
+    measurement.latencies = malloc((corpus->count + 1) * sizeof(double));
+    if(measurement.latencies == NULL) {
+        fprintf(stderr, "Error allocating the measurements\n");
+        exit(1);
+    }
+    measurement.has_nodes = true;
+
+    double start = bench_clock();
+    for(int i = 0; i < corpus->count; i++) {
+        Sudoku sudoku = corpus->puzzles[i];
+        double begin = bench_clock();
+        long nodes = engine(&sudoku);
+        measurement.latencies[i] = bench_clock() - begin;
+        if(nodes < 0) {
+            measurement.has_nodes = false;
+        } else {
+            measurement.nodes += nodes;
+        }
+    }
+    measurement.seconds = bench_clock() - start;
+    measurement.count = corpus->count;
+
+    report(name, corpus->name, &measurement);
+    free(measurement.latencies);
+}
+
+
+/**
+ * Function: bench_generator
+ * -------------------------
+ * Generates puzzles of every level with `generate_puzzle` and reports one measurement per level.
+ * Each level uses its own generator seeded from `seed`, so runs are reproducible.
+ *
+ * Parameters:
+ * - seeds: Seed bank used for levels 3 and 4.
+ * - n_puzzles: Number of puzzles generated for each level.
+ * - seed: Seed of the random generators.
+ */
+static void bench_generator(const SeedBank *seeds, int n_puzzles, uint64_t seed) {
+    double *latencies = malloc((n_puzzles + 1) * sizeof(double));
+    if(latencies == NULL) {
+        fprintf(stderr, "Error allocating the measurements\n");
+        exit(1);
+    }
+
+    for(int level = 1; level <= 4; level++) {
+        Rng rng;
+        rng_seed(&rng, seed + level);
+        Measurement measurement = { latencies, n_puzzles, 0, false, 0.0 };
+
+#ifdef SOLVER_COUNTERS
+        SolverStats stats = {0};
+        counters_attach(&stats);
+#endif
+        double start = bench_clock();
+        for(int i = 0; i < n_puzzles; i++) {
+            Sudoku sudoku;
+            double begin = bench_clock();
+            if(!generate_puzzle(&sudoku, level, seeds, ".", false, NULL, 0, &rng)) {
+                fprintf(stderr, "Could not generate a puzzle of level %d\n", level);
+                exit(1);
+            }
+            latencies[i] = bench_clock() - begin;
+        }
+        measurement.seconds = bench_clock() - start;
+#ifdef SOLVER_COUNTERS
+        counters_attach(NULL);
+        measurement.nodes = stats.counters.nodes;
+        measurement.has_nodes = true;
+#endif
+
+        char name[16];
+        snprintf(name, sizeof(name), "level%d", level);
+        report("generator", name, &measurement);
+    }
+    free(latencies);
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- TECHNIQUE MICROBENCHMARKS --- //
+
+
+/**
+ * Function: collect_states
+ * ------------------------
+ * Solves every puzzle of the corpora with the human solver, recording its state at the start of every round.
+ *
+ * Parameters:
+ * - corpora: Array of corpora.
+ * - n_corpora: Number of corpora.
+ * - n_states: Pointer receiving the number of states.
+ *
+ * Returns:
+ * - The array of states (to be freed by the caller).
+ */
+static SolverState *collect_states(const Corpus *corpora, int n_corpora, int *n_states) {
+    static SolverState scratch[STATES_PER_PUZZLE];
+    SolverState *states = NULL;
+    int capacity = 0;
+    *n_states = 0;
+
+    for(int c = 0; c < n_corpora; c++) {
+        for(int i = 0; i < corpora[c].count; i++) {
+            Sudoku sudoku = corpora[c].puzzles[i];
+            int count = record_states(&sudoku, scratch, STATES_PER_PUZZLE);
+            if(*n_states + count > capacity) {
+                while(*n_states + count > capacity) capacity = (capacity == 0) ? 4096 : 2 * capacity;
+                SolverState *grown = realloc(states, capacity * sizeof(SolverState));
+                if(grown == NULL) {
+                    fprintf(stderr, "Error allocating the solver states\n");
+                    exit(1);
+                }
+                states = grown;
+            }
+            memcpy(states + *n_states, scratch, count * sizeof(SolverState));
+            *n_states += count;
+        }
+    }
+    return states;
+}
+
+
+/**
+ * Function: bench_techniques
+ * --------------------------
+ * Times every technique of the human solver on the mid-solve states of the corpora and prints one JSON line
+ * per technique (see the format above).
+ *
+ * Parameters:
+ * - corpora: Array of corpora.
+ * - n_corpora: Number of corpora.
+ * - repeat: Number of passes over the states for each technique.
+ */
+static void bench_techniques(const Corpus *corpora, int n_corpora, int repeat) {
+    int n_states;
+    SolverState *states = collect_states(corpora, n_corpora, &n_states);
+    bool *hits = calloc((size_t)n_states * N_TECHNIQUES + 1, sizeof(bool));
+    if(hits == NULL) {
+        fprintf(stderr, "Error allocating the measurements\n");
+        exit(1);
+    }
+
+    // Cost of copying the states, which every call below pays as well
+    volatile unsigned short sink;
+    double begin = bench_clock();
+    for(int r = 0; r < repeat; r++) {
+        for(int i = 0; i < n_states; i++) {
+            SolverState state = states[i];
+            sink = state.candidates[i % N][0];
+        }
+    }
+    double baseline = bench_clock() - begin;
+    (void)sink;
+
+    double ns_per_call[N_TECHNIQUES];
+    long n_hits[N_TECHNIQUES];
+    long calls = (long)repeat * n_states;
+    for(int technique = 0; technique < N_TECHNIQUES; technique++) {
+        SolverStats stats = {0};
+        n_hits[technique] = 0;
+        begin = bench_clock();
+        for(int r = 0; r < repeat; r++) {
+            for(int i = 0; i < n_states; i++) {
+                SolverState state = states[i];
+                bool hit = apply_technique(technique, &state, &stats);
+                hits[(size_t)i * N_TECHNIQUES + technique] = hit;
+                n_hits[technique] += hit;
+            }
+        }
+        double elapsed = bench_clock() - begin - baseline;
+        ns_per_call[technique] = (calls > 0 && elapsed > 0) ? elapsed * 1e9 / calls : 0.0;
+    }
+
+    // The solver tries the techniques in order and stops at the first one that makes progress
+    long reached[N_TECHNIQUES] = {0};
+    for(int i = 0; i < n_states; i++) {
+        for(int technique = 0; technique < N_TECHNIQUES; technique++) {
+            reached[technique]++;
+            if(hits[(size_t)i * N_TECHNIQUES + technique]) break;
+        }
+    }
+
+    for(int technique = 0; technique < N_TECHNIQUES; technique++) {
+        printf("{\"technique\":\"%s\",\"states\":%d,\"calls\":%ld,\"ns_per_call\":%.1f,\"hit_rate\":%.4f,"
+               "\"solver_calls\":%ld,\"solver_ms\":%.3f}\n",
+               technique_name(technique), n_states, calls, ns_per_call[technique],
+               calls > 0 ? (double)n_hits[technique] / calls : 0.0,
+               reached[technique], reached[technique] * ns_per_call[technique] * 1e-6);
+    }
+    fflush(stdout);
+    free(hits);
+    free(states);
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- CORPORA --- //
+
+
+/**
+ * Function: load_corpus
+ * ---------------------
+ * Reads every puzzle of a corpus file in the one-line format (see `next_record`); malformed lines are skipped.
+ *
+ * Parameters:
+ * - corpus: Pointer to the Corpus structure to be filled, named after the file.
+ * - path: Path to the corpus file.
+ *
+ * Returns:
+ * - true if the file could be read,
+ *   false otherwise.
+ */
+static bool load_corpus(Corpus *corpus, const char *path) {
+    MappedFile file;
+    if(!map_file(&file, path)) {
+        return false;
+    }
+
+    const char *name = strrchr(path, '/');
+    const char *windows_name = strrchr(path, '\\');
+    if(windows_name != NULL && (name == NULL || windows_name > name)) name = windows_name;
+    corpus->name = (name != NULL) ? name + 1 : path;
+    corpus->puzzles = NULL;
+    corpus->count = 0;
+
+    int capacity = 0;
+    LineRange range = mapped_lines(&file);
+    long line;
+    Sudoku sudoku;
+    RecordStatus status;
+    while((status = next_record(&range, &sudoku, &line)) != RECORD_END) {
+        if(status != RECORD_PUZZLE) continue;
+        if(corpus->count == capacity) {
+            capacity = (capacity == 0) ? 256 : 2 * capacity;
+            Sudoku *puzzles = realloc(corpus->puzzles, capacity * sizeof(Sudoku));
+            if(puzzles == NULL) {
+                fprintf(stderr, "Error allocating the corpus\n");
+                exit(1);
+            }
+            corpus->puzzles = puzzles;
+        }
+        corpus->puzzles[corpus->count++] = sudoku;
+    }
+    unmap_file(&file);
+    return true;
+}
+
+
+/**
+ * Function: load_seed_corpus
+ * --------------------------
+ * Gathers the seed puzzles of every level into a corpus named "seeds".
+ *
+ * Parameters:
+ * - corpus: Pointer to the Corpus structure to be filled.
+ * - seeds: The loaded seed bank.
+ */
+static void load_seed_corpus(Corpus *corpus, const SeedBank *seeds) {
+    static Sudoku puzzles[(MAX_SEED_LEVEL + 1) * MAX_SEEDS_PER_LEVEL];
+    corpus->name = "seeds";
+    corpus->puzzles = puzzles;
+    corpus->count = 0;
+    for(int level = 1; level <= MAX_SEED_LEVEL; level++) {
+        for(int i = 0; i < seed_bank_count(seeds, level); i++) {
+            puzzles[corpus->count++] = *seed_bank_get(seeds, level, i);
+        }
+    }
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- MAIN FUNCTION --- //
+
+
+/**
+ * Function: main
+ * --------------
+ * Entry point of the benchmark: runs every solving engine on the seed puzzles and on each corpus file given,
+ * then generates `--generate N` puzzles of every level (DEFAULT_GENERATED by default, 0 to skip), and prints
+ * one JSON line per measurement on stdout (see the format above).
+ * With `--engine NAME` only that engine is run, and `--seed S` changes the seed of the generator runs.
+ * With `--techniques` the techniques of the human solver are timed one by one instead, on the states of the
+ * human solves of the same puzzles, in `--repeat R` passes (DEFAULT_REPEAT by default).
+ *
+ * Returns:
+ * - 0 on success, or an error code for invalid inputs.
+ */
+int main(
+    int argc,
+    char *argv[]
+) {
+    const char *usage = "Usage: %s <seeds_path> [corpus_file ...] [--generate N] [--seed S] [--engine backtrack|bitmask|human|generator]\n"
+                        "       %s <seeds_path> [corpus_file ...] --techniques [--repeat R]\n";
+    if(argc < 2) {
+        fprintf(stderr, usage, argv[0], argv[0]);
+        return 1;
+    }
+
+    int n_generated = DEFAULT_GENERATED;
+    uint64_t seed = DEFAULT_SEED;
+    const char *only = NULL;
+    bool techniques = false;
+    int repeat = DEFAULT_REPEAT;
+    const char **corpus_files = malloc(argc * sizeof(char *));
+    int n_corpus_files = 0;
+    if(corpus_files == NULL) {
+        fprintf(stderr, "Error allocating the arguments\n");
+        return 1;
+    }
+    for(int i = 2; i < argc; i++) {
+        if(strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            n_generated = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if(strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if(strcmp(argv[i], "--techniques") == 0) {
+            techniques = true;
+        } else if(strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if(strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, usage, argv[0], argv[0]);
+            free(corpus_files);
+            return 1;
+        } else {
+            corpus_files[n_corpus_files++] = argv[i];
+        }
+    }
+
+    static SeedBank seeds;
+    seed_bank_load(&seeds, argv[1]);
+
+    // Every corpus is loaded up front, so a missing file stops the run before any measurement
+    Corpus *corpora = malloc((n_corpus_files + 1) * sizeof(Corpus));
+    if(corpora == NULL) {
+        fprintf(stderr, "Error allocating the corpora\n");
+        free(corpus_files);
+        return 1;
+    }
+    load_seed_corpus(&corpora[0], &seeds);
+    for(int i = 0; i < n_corpus_files; i++) {
+        if(!load_corpus(&corpora[i + 1], corpus_files[i])) {
+            fprintf(stderr, "Error reading the corpus '%s'\n", corpus_files[i]);
+            for(int j = 1; j <= i; j++) free(corpora[j].puzzles);
+            free(corpora);
+            free(corpus_files);
+            return 1;
+        }
+    }
+
+    if(techniques) {
+        bench_techniques(corpora, n_corpus_files + 1, repeat > 0 ? repeat : 1);
+    } else {
+        const char *names[] = { "backtrack", "bitmask", "human" };
+        Engine engines[] = { run_backtrack, run_bitmask, run_human };
+        for(int e = 0; e < 3; e++) {
+            if(only != NULL && strcmp(only, names[e]) != 0) continue;
+            for(int i = 0; i <= n_corpus_files; i++) {
+                bench_solver(names[e], engines[e], &corpora[i]);
+            }
+        }
+        if(n_generated > 0 && (only == NULL || strcmp(only, "generator") == 0)) {
+            bench_generator(&seeds, n_generated, seed);
+        }
+    }
+
+    for(int i = 1; i <= n_corpus_files; i++) free(corpora[i].puzzles);
+    free(corpora);
+    free(corpus_files);
+    return 0;
+}
@@ -0,0 +1,379 @@
+#include "canon.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/******************************************************************************
+ * Minlex Canonical Form
+ * Two puzzles are equivalent when one can be turned into the other by the
+ * symmetry group of transform.c (transposition, band/row and stack/column
+ * permutations, digit relabeling). The canonical form of a puzzle is the
+ * lexicographically smallest member of its class, reading the cells row by
+ * row with empty cells as 0 and digits relabeled 1, 2, ... in order of first
+ * appearance. Equivalent puzzles have the same canonical form.
+ *
+ * The search builds the result one row at a time and only keeps the partial
+ * transformations whose rows so far are minimal:
+ * - columns that are empty in every row placed so far are interchangeable, as
+ *   are whole stacks of such columns, so their order is left open: a new row
+ *   puts its empty cells first among them, and only the orders of its digits
+ *   are tried;
+ * - the first row of a band tries the rows of the unused bands, the next rows
+ *   only the unused rows of the current band.
+ * Puzzles keep most of their columns open for several rows and take about
+ * ten microseconds. The worst case is a grid of complete rows (a solved grid):
+ * every one of the 18 candidate first rows gives 123456789 in all its 6 stack
+ * orders times 6^3 column orders, about 23000 states that only the second row
+ * cuts down (under a millisecond). Grids repeating digits within a row, which
+ * are not valid puzzles, can take longer.
+ ******************************************************************************/
+
+
+/**
+ * Struct: CanonState
+ * ------------------
+ * Partial transformation whose first rows give the smallest prefix found so far.
+ * The first `free_stacks` stacks, and the first `free_cols` columns of every stack, are empty in all the rows
+ * placed so far: they can still be permuted, and `cols` only holds one of their orders.
+ *
+ * Fields:
+ * - transpose: Whether the source grid is read transposed.
+ * - cols: Source column of each result column.
+ * - label: Label given to each source digit so far (0 if the digit has not appeared yet).
+ * - next_label: Label that the next new digit receives.
+ * - last_row: Source row of the last result row.
+ * - used_rows: Bitmask of the source rows already placed.
+ * - free_stacks: Number of leading stacks whose order is still open.
+ * - free_cols: Number of leading columns of each stack whose order is still open.
+ */
+typedef struct {
+    unsigned char transpose;
+    unsigned char cols[N];
+    unsigned char label[10];
+    unsigned char next_label;
+    unsigned char last_row;
+    unsigned short used_rows;
+    unsigned char free_stacks;
+    unsigned char free_cols[3];
+} CanonState;
+
+typedef struct {
+    CanonState *states;
+    int count;
+    int capacity;
+} CanonList;
+
+// Free columns (unit 1) or free stacks (unit 3) holding digits, whose orders are tried when a row is placed.
+// The column ties come first: the stack tie, if any, carries them along.
+typedef struct {
+    int start;
+    int length;
+    int unit;
+} CanonTie;
+
+
+static const unsigned char PERMS3[6][3] = {
+    {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}
+};
+
+
+/**
+ * Function: canon_push
+ * --------------------
+ * Appends a state to a list, growing it when needed.
+ *
+ * Returns:
+ * - false if the list could not be grown.
+ */
+static bool canon_push(CanonList *list, const CanonState *state) {
+    if(list->count == list->capacity) {
+        int capacity = list->capacity ? 2 * list->capacity : 256;
+        CanonState *states = realloc(list->states, capacity * sizeof(CanonState));
+        if(states == NULL) {
+            return false;
+        }
+        list->states = states;
+        list->capacity = capacity;
+    }
+    list->states[list->count++] = *state;
+    return true;
+}
+
+
+/**
+ * Function: move_stack
+ * --------------------
+ * Moves the stack at position `from` to position `to` (not after it), shifting the stacks in between.
+ */
+static void move_stack(unsigned char cols[N], int from, int to) {
+    unsigned char stack[3];
+    memcpy(stack, cols + 3 * from, 3);
+    memmove(cols + 3 * (to + 1), cols + 3 * to, 3 * (from - to));
+    memcpy(cols + 3 * to, stack, 3);
+}
+
+
+/**
+ * Function: build_row
+ * -------------------
+ * Builds the row that the column order of a state gives to a source row, labeling the new digits,
+ * and compares it with the best row as it goes: the building stops as soon as the row gets larger.
+ *
+ * Parameters:
+ * - state: The state, whose labels are updated.
+ * - source: The 9 cells of the source row.
+ * - best: The best row found so far, or NULL to build the row without comparing it.
+ * - row: Buffer receiving the row.
+ *
+ * Returns:
+ * - A negative number, 0 or a positive number as the row is smaller, equal or larger than `best` (0 without `best`).
+ */
+static int build_row(CanonState *state, const unsigned char source[N], const unsigned char *best, unsigned char row[N]) {
+    int cmp = 0;
+    for(int j = 0; j < N; j++) {
+        int digit = source[state->cols[j]];
+        if(digit != 0 && state->label[digit] == 0) {
+            state->label[digit] = state->next_label++;
+        }
+        row[j] = state->label[digit];
+        if(best != NULL && cmp == 0 && row[j] != best[j]) {
+            if(row[j] > best[j]) {
+                return 1;
+            }
+            cmp = -1;
+        }
+    }
+    return cmp;
+}
+
+
+/**
+ * Function: keep_row
+ * ------------------
+ * Adds a state to the list if its row is not larger than the best one, after emptying the list
+ * and recording the row as the best one if it is smaller.
+ *
+ * Returns:
+ * - false if the list could not be grown.
+ */
+static bool keep_row(CanonList *list, const CanonState *state, int cmp, const unsigned char row[N], unsigned char best[N], bool *found) {
+    if(cmp > 0) {
+        return true;
+    }
+    if(cmp < 0 || !*found) {
+        memcpy(best, row, N);
+        list->count = 0;
+        *found = true;
+    }
+    return canon_push(list, state);
+}
+
+
+/**
+ * Function: place_row
+ * -------------------
+ * Places a source row as the next result row of a state. Empty cells go first among the free columns
+ * of every stack, and empty stacks first among the free stacks: the columns and stacks left empty stay free.
+ * Every order of the other free cells and stacks is then tried, and the ones whose row is not larger than
+ * the best row found so far are added to the list (after emptying the list if the row is smaller).
+ *
+ * Parameters:
+ * - list: List receiving the extended states.
+ * - state: The state to extend.
+ * - source: The 9 cells of the source row.
+ * - source_row: Index of the source row.
+ * - best: The best row found so far, updated when the row is smaller.
+ * - found: Whether `best` holds a row yet, set when it does.
+ *
+ * Returns:
+ * - false if the list could not be grown.
+ */
+static bool place_row(
+    CanonList *list,
+    const CanonState *state,
+    const unsigned char source[N],
+    int source_row,
+    unsigned char best[N],
+    bool *found
+) {
+    CanonState extended = *state;
+    extended.last_row = source_row;
+    extended.used_rows |= 1 << source_row;
+    unsigned char row[N];
+
+    // Without free columns there is a single order (this is the case of most rows)
+    if(state->free_stacks == 0 && (state->free_cols[0] | state->free_cols[1] | state->free_cols[2]) == 0) {
+        int cmp = build_row(&extended, source, *found ? best : NULL, row);
+        return keep_row(list, &extended, cmp, row, best, found);
+    }
+
+    // Empty stacks first among the free stacks, keeping their order
+    unsigned char sorted[N], free_cols[3];
+    memcpy(sorted, state->cols, N);
+    extended.free_stacks = 0;
+    for(int s = 0; s < state->free_stacks; s++) {
+        if(source[sorted[3 * s]] == 0 && source[sorted[3 * s + 1]] == 0 && source[sorted[3 * s + 2]] == 0) {
+            move_stack(sorted, s, extended.free_stacks++);
+        }
+    }
+
+    // Then empty cells first among the free columns of every stack, the other ones are orders to try
+    CanonTie ties[4];
+    int n_ties = 0;
+    for(int s = 0; s < 3; s++) {
+        int size = (s < state->free_stacks) ? 3 : state->free_cols[s];
+        unsigned char *cols = sorted + 3 * s;
+        int empty = 0;
+        for(int k = 0; k < size; k++) {
+            if(source[cols[k]] == 0) {
+                unsigned char col = cols[k];
+                memmove(cols + empty + 1, cols + empty, k - empty);
+                cols[empty++] = col;
+            }
+        }
+        free_cols[s] = empty;
+        if(size - empty > 1) {
+            ties[n_ties++] = (CanonTie){ 3 * s + empty, size - empty, 1 };
+        }
+    }
+    if(state->free_stacks - extended.free_stacks > 1) {
+        ties[n_ties++] = (CanonTie){ 3 * extended.free_stacks, state->free_stacks - extended.free_stacks, 3 };
+    }
+
+    // When the cells to order are distinct digits without a label, and the stacks to order have as many
+    // empty cells, every order gives the same row: it is only compared once (this is the case of every first row)
+    bool same_row = n_ties > 0;
+    unsigned short digits = 0;
+    for(int j = 0; j < N && same_row; j++) {
+        int digit = source[sorted[j]];
+        same_row = digit == 0 || !(digits & (1 << digit));
+        digits |= 1 << digit;
+    }
+    for(int t = 0; t < n_ties && same_row; t++) {
+        for(int j = ties[t].start; j < ties[t].start + ties[t].length * ties[t].unit; j++) {
+            same_row = same_row && state->label[source[sorted[j]]] == 0;
+        }
+        for(int k = 1; k < ties[t].length && ties[t].unit == 3; k++) {
+            same_row = same_row && free_cols[ties[t].start / 3 + k] == free_cols[ties[t].start / 3];
+        }
+    }
+
+    // One candidate per order: the columns first, then the stacks carry them along
+    bool compare = true;
+    int choice[4] = {0};
+    while(true) {
+        unsigned char *cols = extended.cols;
+        memcpy(cols, sorted, N);
+        memcpy(extended.free_cols, free_cols, 3);
+        for(int t = 0; t < n_ties; t++) {
+            // Orders of 2 elements are the ones of 3 elements keeping the last one in place
+            const unsigned char *perm = PERMS3[(ties[t].length == 2) ? 2 * choice[t] : choice[t]];
+            int start = ties[t].start;
+            if(ties[t].unit == 1) {
+                for(int k = 0; k < ties[t].length; k++) {
+                    cols[start + k] = sorted[start + perm[k]];
+                }
+                continue;
+            }
+            unsigned char previous[N];
+            memcpy(previous, cols, N);
+            for(int k = 0; k < ties[t].length; k++) {
+                memcpy(cols + start + 3 * k, previous + start + 3 * perm[k], 3);
+                extended.free_cols[start / 3 + k] = free_cols[start / 3 + perm[k]];
+            }
+        }
+
+        memcpy(extended.label, state->label, sizeof(extended.label));
+        extended.next_label = state->next_label;
+        int cmp = build_row(&extended, source, (*found && compare) ? best : NULL, row);
+        if(cmp > 0 && same_row) {
+            return true;
+        }
+        compare = !same_row;
+        if(!keep_row(list, &extended, cmp, row, best, found)) {
+            return false;
+        }
+
+        int t = 0;
+        while(t < n_ties && ++choice[t] == ((ties[t].length == 2) ? 2 : 6)) {
+            choice[t++] = 0;
+        }
+        if(t == n_ties) {
+            return true;
+        }
+    }
+}
+
+
+/**
+ * Function: canonicalize
+ * ----------------------
+ * Computes the minlex canonical form of a puzzle (or of a solved grid).
+ *
+ * Parameters:
+ * - sudoku: Pointer to the puzzle to canonicalize.
+ * - canonical: Pointer to the Sudoku grid receiving the canonical form (may be `sudoku`).
+ */
+void canonicalize(const Sudoku *sudoku, Sudoku *canonical) {
+    unsigned char grid[2][N][N];
+    for(int r = 0; r < N; r++) {
+        for(int c = 0; c < N; c++) {
+            grid[0][r][c] = sudoku->table[r][c];
+            grid[1][c][r] = sudoku->table[r][c];
+        }
+    }
+
+    // One state per orientation, with every column and stack still free
+    unsigned char result[N][N];
+    CanonList current = {0}, next = {0};
+    bool ok = true;
+    for(int t = 0; t < 2 && ok; t++) {
+        CanonState root;
+        memset(&root, 0, sizeof(root));
+        root.transpose = t;
+        root.next_label = 1;
+        root.free_stacks = 3;
+        for(int j = 0; j < N; j++) {
+            root.cols[j] = j;
+        }
+        ok = canon_push(&current, &root);
+    }
+
+    // Extend the surviving states one row at a time, keeping the smallest rows only
+    for(int i = 0; i < N && ok; i++) {
+        next.count = 0;
+        bool found = false;
+        for(int k = 0; k < current.count && ok; k++) {
+            const CanonState *state = &current.states[k];
+            int first = 0, last = N;
+            if(i % 3 != 0) {
+                first = 3 * (state->last_row / 3);
+                last = first + 3;
+            }
+            for(int r = first; r < last && ok; r++) {
+                if(state->used_rows & (1 << r)) continue;
+                if(i % 3 == 0 && (state->used_rows >> (3 * (r / 3))) & 7) continue;
+                ok = place_row(&next, state, grid[state->transpose][r], r, result[i], &found);
+            }
+        }
+        CanonList temp = current;
+        current = next;
+        next = temp;
+    }
+    free(current.states);
+    free(next.states);
+
+    // Without memory for the search, fall back to the puzzle itself so that callers still get a valid grid
+    if(!ok) {
+        if(canonical != sudoku) {
+            memcpy(canonical, sudoku, sizeof(Sudoku));
+        }
+        return;
+    }
+    for(int r = 0; r < N; r++) {
+        for(int c = 0; c < N; c++) {
+            canonical->table[r][c] = result[r][c];
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#ifndef CANON_H
+#define CANON_H
+
+#include "io.h"
+
+void canonicalize(const Sudoku *sudoku, Sudoku *canonical);
+
+#endif
@@ -1,7 +1,18 @@
+#include "generator.h"
 #include "helpers.h"
 #include "io.h"
+#include "pool.h"
 #include "solver_human.h"
+#include "rng.h"
+#include "seed_bank.h"
+#include "server.h"
+#include "solver_bitmask.h"
+#include "store.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "transform.h"
 #include <ctype.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,298 +20,17 @@
 #include <time.h>
 
 #define N_STARTING_PIVOTS 11
-#define N_SOL 5
 #define TIMEOUT_SECONDS 1
+#define MAX_GRID_TRIALS 100000
+#define TARGETED_ATTEMPTS 200
+#define TARGETED_RETRIES 10
+#define TARGETED_CANDIDATES 8
 
-
-/******************************************************************************
- * Random Transformations
- * These preserve Sudoku validity if applied to a fully solved Sudoku.
- * If applied to a partially filled puzzle, they still produce a puzzle with
- * the same solutions (not violating constraints), but some transformations
- * might be less impactful if many cells are still empty.
- ******************************************************************************/
-
-/**
- * Function: permute_digits
- * ------------------------
- * Randomly permutes the digits 1 through 9 in a solved or partially solved Sudoku grid.
- * This transformation replaces each digit with another unique digit, preserving 
- * the Sudoku's validity and solution properties.
- *
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid to be transformed.
- */
-void permute_digits(Sudoku *sudoku) {
-    int map[10];
-    for(int d = 1; d <= 9; d++) {
-        map[d] = d;
-    }
-
-    // Shuffle the map array and apply it to the Sudoku grid
-    for(int d = 9; d >= 2; d--) {
-        int randIndex = rand() % d + 1;
-        int temp = map[d];
-        map[d] = map[randIndex];
-        map[randIndex] = temp;
-    }
-    for(int r = 0; r < 9; r++) {
-        for(int c = 0; c < 9; c++) {
-            int oldVal = sudoku->table[r][c];
-            if(oldVal != 0) {
-                sudoku->table[r][c] = map[oldVal];
-            }
-        }
-    }
-}
-
-
-/**
- * Function: swap_row_bands
- * ------------------------
- * Swaps two entire row bands in the Sudoku grid. A row band consists of three 
- * consecutive rows (e.g. 0–2, 3–5, or 6–8).
- *
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid to be transformed.
- * - bandA: Index of the first row band to swap (0–2).
- * - bandB: Index of the second row band to swap (0–2).
- */
-void swap_row_bands(
-    Sudoku *sudoku,
-    int bandA,
-    int bandB
-) {
-    if(bandA == bandB) return;
-
-    for(int offset = 0; offset < 3; offset++) {
-        int row1 = bandA*3 + offset;
-        int row2 = bandB*3 + offset;
-        for(int col = 0; col < 9; col++) {
-            int temp = sudoku->table[row1][col];
-            sudoku->table[row1][col] = sudoku->table[row2][col];
-            sudoku->table[row2][col] = temp;
-        }
-    }
-}
-
-
-/**
- * Function: swap_col_bands
- * ------------------------
- * Swaps two entire column bands in the Sudoku grid. A column band consists of three 
- * consecutive columns (e.g. 0–2, 3–5, or 6–8).
- *
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid to be transformed.
- * - bandA: Index of the first column band to swap (0–2).
- * - bandB: Index of the second column band to swap (0–2).
- */
-void swap_col_bands(
-    Sudoku *sudoku,
-    int bandA,
-    int bandB
-) {
-    if(bandA == bandB) return;
-
-    for(int offset = 0; offset < 3; offset++) {
-        int col1 = bandA*3 + offset;
-        int col2 = bandB*3 + offset;
-        for(int row = 0; row < 9; row++) {
-            int temp = sudoku->table[row][col1];
-            sudoku->table[row][col1] = sudoku->table[row][col2];
-            sudoku->table[row][col2] = temp;
-        }
-    }
-}
-
-
-/**
- * Function: rotate_sudoku
- * ------------------------
- * Rotates the Sudoku grid by the specified angle: 90, 180, or 270 degrees.
- * The rotation changes the positions of the digits in the grid while preserving the Sudoku's solution properties.
-
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid to be rotated.
- * - angle: The angle by which the Sudoku grid should be rotated (90, 180, or 270 degrees).
- */
-void rotate_sudoku(
-    Sudoku *sudoku,
-    int angle
-) {
-
-    Sudoku temp = *sudoku;
-    if(angle == 90) {
-        for(int r = 0; r < 9; r++) {
-            for(int c = 0; c < 9; c++) {
-                sudoku->table[c][8 - r] = temp.table[r][c];
-            }
-        }
-    } else if(angle == 180) {
-        for(int r = 0; r < 9; r++) {
-            for(int c = 0; c < 9; c++) {
-                sudoku->table[8 - r][8 - c] = temp.table[r][c];
-            }
-        }
-    } else if(angle == 270) {
-        for(int r = 0; r < 9; r++) {
-            for(int c = 0; c < 9; c++) {
-                sudoku->table[8 - c][r] = temp.table[r][c];
-            }
-        }
-    }
-}
-
-
-/**
- * Function: reflect_sudoku
- * -------------------------
- * Reflects the Sudoku grid along the specified axis: horizontal (H) or vertical (V).
- * This transformation adjusts the positions of the digits while preserving the solution properties.
-
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid to be reflected.
- * - axis: The axis of reflection ('H' for horizontal, 'V' for vertical).
- */
-void reflect_sudoku(
-    Sudoku *sudoku,
-    char axis
-) {
-
-    Sudoku temp = *sudoku;
-    if(axis == 'H') {
-        for(int r = 0; r < 9; r++) {
-            for(int c = 0; c < 9; c++) {
-                sudoku->table[r][8 - c] = temp.table[r][c];
-            }
-        }
-    } else if(axis == 'V') {
-        for(int r = 0; r < 9; r++) {
-            for(int c = 0; c < 9; c++) {
-                sudoku->table[8 - r][c] = temp.table[r][c];
-            }
-        }
-    }
-}
-
-
-/**
- * Function: random_transformations
- * --------------------------------
- * Applies a series of random transformations to the Sudoku grid to ensure variability while preserving
- * the Sudoku's validity and solution properties.
- * The transformations include:
- * 1. Permuting digits 1 through 9.
- * 2. Swapping row bands.
- * 3. Swapping column bands.
- * 4. Rotation or reflection of the grid.
- *
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid to be transformed.
- */
-void random_transformations(Sudoku *sudoku) {
-
-    // Permute digits
-    permute_digits(sudoku);
-
-    // Swap row and column bands randomly twice
-    int bandA = rand() % 3;
-    int bandB = rand() % 3;
-    swap_row_bands(sudoku, bandA, bandB);
-    bandA = rand() % 3;
-    bandB = rand() % 3;
-    swap_row_bands(sudoku, bandA, bandB);
-    bandA = rand() % 3;
-    bandB = rand() % 3;
-    swap_col_bands(sudoku, bandA, bandB);
-    bandA = rand() % 3;
-    bandB = rand() % 3;
-    swap_col_bands(sudoku, bandA, bandB);
-
-    // Rotate or reflect the grid
-    int transform = rand() % 5;
-    if(transform < 3) {
-        rotate_sudoku(sudoku, (transform + 1) * 90);
-    } else {
-        reflect_sudoku(sudoku, (transform == 3) ? 'H' : 'V');
-    }
-}
-
-
-// ---------------------------------------------------------------------------------------------------- //
-// --- UNIQUE SOLUTION CHECKER --- //
-
-
-/**
- * Function: count_solutions_recursive
- * -----------------------------------
- * Helper function that recursively counts the number of solutions for a given Sudoku puzzle using backtracking.
- * Tracks the number of trials (search steps) and ensures computation stays within a given timeout.
-
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid.
- * - n_solutions: Pointer to a variable that tracks the number of solutions found.
- * - trials: Pointer to a variable that tracks the number of search steps.
- * - start_time: The clock time when the function was called in dynamic_dig, used for timeout checks.
-
- * Returns:
- * - The total number of solutions found.
- */
-int count_solutions_recursive(
-    Sudoku *sudoku,
-    int *n_solutions,
-    int *trials,
-    time_t start_time
-) {
-    int row, col;
-
-    time_t current_time = time(NULL);
-    double elapsed_time = ((double)(current_time - start_time)) / CLOCKS_PER_SEC;
-    if(elapsed_time > TIMEOUT_SECONDS) {
-        // printf("\nTimeout exceeded during grid generation!\n");
-        return false;
-    }
-
-    if(!find_empty(sudoku, &row, &col)) {
-        (*n_solutions)++;
-        return *n_solutions;
-    }
-    for(int guess = 1; guess <= 9; guess++) {
-        (*trials)++;
-        if(is_valid(sudoku, guess, row, col)) {
-            sudoku->table[row][col] = guess;
-            if(count_solutions_recursive(sudoku, n_solutions, trials, start_time) == N_SOL) {
-                return N_SOL;
-            }
-            sudoku->table[row][col] = 0;
-        }
-    }
-    return *n_solutions;
-}
-
-
-/**
- * Function: count_solutions
- * -------------------------
- * Counts the number of solutions for a given Sudoku puzzle using the recursive helper function `count_solutions_recursive`.
- * Includes timeout management to prevent excessive computation.
-
- * Parameters:
- * - sudoku: Pointer to the Sudoku grid.
- * - start_time: The clock time when the function was called in dynamic_dig, used for timeout checks.
-
- * Returns:
- * - The total number of solutions for the Sudoku grid. If the timeout is exceeded, the count may be incomplete.
- */
-int count_solutions(
-    Sudoku *sudoku,
-    time_t start_time
-) {
-    int n_solutions = 0;
-    int trials = 0;
-    return count_solutions_recursive(sudoku, &n_solutions, &trials, start_time);
-}
+#ifdef _WIN32
+    #define PATH_SEPARATOR "\\"
+#else
+    #define PATH_SEPARATOR "/"
+#endif
 
 
 // ---------------------------------------------------------------------------------------------------- //
@@ -312,22 +42,34 @@ int count_solutions(
  * ----------------------
  * Attempts to solve the given Sudoku puzzle using a backtracking algorithm. 
  * Tracks the number of solutions found and ensures computation stays within a timeout limit.
+ * The search is also capped at MAX_GRID_TRIALS steps: random pivots occasionally lead to a search that
+ * takes millions of steps, and giving up on them is deterministic, unlike the timeout, so seeded runs
+ * stay reproducible.
 
  * Parameters:
  * - sudoku: Pointer to the Sudoku grid to be solved.
  * - n_solutions: Pointer to a variable that tracks the number of solutions found.
+ * - trials: Pointer to a variable that tracks the number of search steps.
  * - start_time: The clock time when the function generate_valid_grid was called, used for timeout checks.
+ * - depth: Depth of the call in the search (1 for the root), for the instrumentation counters.
 
  * Returns:
  * - true if the grid has at least one solution (indicating a valid puzzle), false otherwise.
  */
-bool solve_sudoku(
+static bool solve_sudoku(
     Sudoku *sudoku,
     int *n_solutions,
-    time_t start_time
+    int *trials,
+    time_t start_time,
+    int depth
 ) {
     int row, col;
 
+    count_node(depth);
+    if(++(*trials) > MAX_GRID_TRIALS) {
+        return false;
+    }
+
     time_t current_time = time(NULL);
     double elapsed_time = ((double)(current_time - start_time)) / CLOCKS_PER_SEC;
     if(elapsed_time > TIMEOUT_SECONDS) {
@@ -346,11 +88,12 @@ bool solve_sudoku(
     for(int guess = 1; guess <= 9; guess++) {
         if(is_valid(sudoku, guess, row, col)) {
             sudoku->table[row][col] = guess;
-            if(solve_sudoku(sudoku, n_solutions, start_time)) {
+            if(solve_sudoku(sudoku, n_solutions, trials, start_time, depth + 1)) {
                 if(*n_solutions == N_SOL) {
                     return true;
                 }
             }
+            count_backtrack();
             sudoku->table[row][col] = 0;
         }
     }
@@ -367,12 +110,16 @@ bool solve_sudoku(
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku structure to be modified.
+ * - rng: Pointer to the random generator of the calling context.
  *
  * Returns:
  * - true if the grid is successfully generated within the allowed time, false otherwise.
  */
-bool generate_valid_grid(Sudoku *sudoku) {
-
+bool generate_valid_grid(
+    Sudoku *sudoku,
+    Rng *rng
+) {
+    TRACE_SCOPE("generate_valid_grid");
     time_t start_time = time(NULL);
 
     while (true) {
@@ -384,9 +131,9 @@ bool generate_valid_grid(Sudoku *sudoku) {
         }
 
         for(int i = 0; i < N_STARTING_PIVOTS; i++) {
-            int row = rand() % 9;
-            int col = rand() % 9;
-            int guess = rand() % 9 + 1;
+            int row = rng_int(rng, 9);
+            int col = rng_int(rng, 9);
+            int guess = rng_int(rng, 9) + 1;
             if(is_valid(sudoku, guess, row, col)) {
                 sudoku->table[row][col] = guess;
             }
@@ -394,7 +141,8 @@ bool generate_valid_grid(Sudoku *sudoku) {
 
         // Terminate if the puzzle has a solution and reset the grid otherwise
         int n_solutions = 0;
-        if(solve_sudoku(sudoku, &n_solutions, start_time)) {
+        int trials = 0;
+        if(solve_sudoku(sudoku, &n_solutions, &trials, start_time, 1)) {
             return true;
         }
         else {
@@ -418,15 +166,17 @@ bool generate_valid_grid(Sudoku *sudoku) {
  * Randomly selects the next cell in the Sudoku grid to attempt removal or modification during the digging phase.
 
  * Parameters:
+ * - rng: Pointer to the random generator of the calling context.
  * - row: Pointer to an integer holfing the row index of the selected cell.
  * - col: Pointer to an integer holfing the column index of the selected cell.
  */
 void get_next_cell(
+    Rng *rng,
     int *row,
     int *col
 ) {
-    *row = rand() % N;
-    *col = rand() % N;
+    *row = rng_int(rng, N);
+    *col = rng_int(rng, N);
 }
 
 
@@ -438,6 +188,7 @@ void get_next_cell(
 
  * Parameters:
  * - level: Desired difficulty level (1–4).
+ * - rng: Pointer to the random generator of the calling context.
 
  * Returns:
  * - A random value for the number of cells to be fillec:
@@ -446,16 +197,18 @@ void get_next_cell(
  *   Level 3: 24–28 cells.
  *   Level 4: 19–24 cells.
  */
-int sample_cells_bound(int level) {
-    int bound = rand();
+int sample_cells_bound(
+    int level,
+    Rng *rng
+) {
     if(level == 1) {
-        return bound % 7 + 33;
+        return rng_int(rng, 7) + 33;
     } else if(level == 2) {
-        return bound % 5 + 28;
+        return rng_int(rng, 5) + 28;
     } else if(level == 3) {
-        return bound % 4 + 24;
+        return rng_int(rng, 4) + 24;
     } else if(level == 4) {
-        return bound % 5 + 19;
+        return rng_int(rng, 5) + 19;
     }
     return 30;
 }
@@ -476,13 +229,17 @@ int sample_cells_bound(int level) {
  * - sudoku: Pointer to the Sudoku grid to be modified.
  * - level: Desired difficulty level (1–4).
  * - cell_bound: Minimum number of cells that must remain filled in the puzzle.
+ * - output_path: Path forwarded to the human solver.
+ * - rng: Pointer to the random generator of the calling context.
  */
 void dynamic_dig(
     Sudoku *sudoku,
     int level,
     int cell_bound,
-    char *output_path
+    char *output_path,
+    Rng *rng
 ) {
+    TRACE_SCOPE("dynamic_dig");
     int total_givens = 81;
     time_t start_time = time(NULL);
     bool solving_mode = false;
@@ -495,8 +252,8 @@ void dynamic_dig(
             break;
         }
 
-        int row = rand() % 9;
-        int col = rand() % 9;
+        int row = rng_int(rng, 9);
+        int col = rng_int(rng, 9);
         if(sudoku->table[row][col] == 0) continue;
 
         int backup = sudoku->table[row][col];
@@ -525,6 +282,55 @@ void dynamic_dig(
 // ---------------------------------------------------------------------------------------------------- //
 // --- LEVEL ASSESSMENT --- //
 
+
+/**
+ * Function: stats_level
+ * ---------------------
+ * Maps the techniques used by the human solver to a difficulty level.
+
+ * Parameters:
+ * - stats: Pointer to a `SolverStats` structure filled by the human solver.
+
+ * Returns:
+ * - The level (1–4) of the hardest technique that was needed.
+ */
+int stats_level(SolverStats *stats) {
+
+    // Use flags to determine the assessed level
+    bool requires_level_2 = ((stats->naked_pair + stats->hidden_pair + stats->pointing_pair) > 0);
+    bool requires_level_3 = ((stats->naked_triple + stats->pointing_triple + stats->hidden_triple) > 0);
+    bool requires_level_4 = stats->x_wing > 0;
+    if(requires_level_4) {
+        return 4;
+    } else if(requires_level_3) {
+        return 3;
+    } else if(requires_level_2) {
+        return 2;
+    }
+    return 1;
+}
+
+
+/**
+ * Function: stats_score
+ * ---------------------
+ * Rates how demanding a human solve was, weighting each technique by its level.
+ * Used to rank puzzles of the same level against each other.
+
+ * Parameters:
+ * - stats: Pointer to a `SolverStats` structure filled by the human solver.
+
+ * Returns:
+ * - The weighted number of technique applications.
+ */
+int stats_score(SolverStats *stats) {
+    return stats->naked_single + 2 * stats->hidden_single
+        + 10 * (stats->naked_pair + stats->hidden_pair + stats->pointing_pair)
+        + 50 * (stats->naked_triple + stats->hidden_triple + stats->pointing_triple)
+        + 100 * stats->x_wing;
+}
+
+
 /**
  * Function: assess_level
  * ----------------------
@@ -535,6 +341,8 @@ void dynamic_dig(
  * - sudoku: Pointer to the Sudoku grid to be assessed.
  * - stats: Pointer to a `SolverStats` structure that tracks the solving techniques used.
  * - input_level: The desired difficulty level (1–4).
+ * - solving_mode: Whether to record the moves made by the human solver in the log file.
+ * - output_path: Path to the folder containing the log file.
 
  * Returns:
  * - The assessed difficulty level if it matches `input_level`.
@@ -544,32 +352,20 @@ int assess_level(
     Sudoku *sudoku,
     SolverStats *stats,
     int input_level,
+    bool solving_mode,
     char *output_path
 ) {
-    
+    TRACE_SCOPE("assess_level");
+
     // Use the human solver and track the techniques used
     Sudoku sudoku_copy;
     memcpy(&sudoku_copy, sudoku, sizeof(Sudoku));
-    bool solving_mode = true;
     if(!solve_human(&sudoku_copy, stats, solving_mode, output_path)) {
         return -1;
     }
 
-    // Use flags to determine the assessed level
-    bool requires_level_1 = stats->naked_single > 0 || stats->hidden_single > 0;
-    bool requires_level_2 = ((stats->naked_pair + stats->hidden_pair + stats->pointing_pair) > 0);
-    bool requires_level_3 = ((stats->naked_triple + stats->pointing_triple + stats->hidden_triple) > 0);
-    bool requires_level_4 = stats->x_wing > 0;
-    int assessed_level = 1;
-    if(requires_level_4) {
-        assessed_level = 4;
-    } else if(requires_level_3) {
-        assessed_level = 3;
-    } else if(requires_level_2) {
-        assessed_level = 2;
-    }
-
     // Check if the assessed level matches the input level
+    int assessed_level = stats_level(stats);
     if(assessed_level != input_level) {
         return -1;
     }
@@ -578,142 +374,1074 @@ int assess_level(
 
 
 // ---------------------------------------------------------------------------------------------------- //
-// --- MAIN FUNCTION --- //
+// --- PARALLEL DIGGING --- //
 
 
-const char *level_3_seeds[] = {
-    "Level3\\puzzle1.txt",
-    "Level3\\puzzle2.txt",
-    "Level3\\puzzle3.txt",
-    "Level3\\puzzle4.txt",
-    "Level3\\puzzle5.txt",
-    "Level3\\puzzle6.txt",
-    "Level3\\puzzle7.txt",
-    "Level3\\puzzle8.txt",
-    "Level3\\puzzle9.txt",
-    "Level3\\puzzle10.txt"
-};
-
-const char *level_4_seeds[] = {
-    "Level4\\puzzle1.txt",
-    "Level4\\puzzle2.txt",
-    "Level4\\puzzle3.txt",
-    "Level4\\puzzle4.txt",
-    "Level4\\puzzle5.txt"
-};
+/**
+ * Struct: DigCandidate
+ * --------------------
+ * A speculative removal evaluated by a worker thread during parallel digging.
+ *
+ * Fields:
+ * - sudoku: Puzzle with the candidate cell removed.
+ * - row, col: Position of the removed cell.
+ * - output_path: Path forwarded to the human solver.
+ * - unique: Whether the puzzle is human solvable and has a unique solution.
+ * - assessed_level: Level required by the human solver.
+ * - score: Rating of the human solve (see `stats_score`).
+ */
+typedef struct {
+    Sudoku sudoku;
+    int row;
+    int col;
+    char *output_path;
+    bool unique;
+    int assessed_level;
+    int score;
+} DigCandidate;
 
 
 /**
- * Function: main
- * --------------
- * Entry point for the Sudoku generator program. Handles puzzle generation for difficulty levels 1–4.
- * Levels 1–2 are generated dynamically using a structured digging process, while levels 3–4 are based on pre-existing seed puzzles with random transformations.
+ * Function: evaluate_candidate
+ * ----------------------------
+ * Task run on the thread pool: rates a candidate removal with the human solver and checks that
+ * the solution is still unique. Works on private copies only, so candidates can run concurrently.
 
- * Key Steps:
- * 1. Accepts user input for the desired difficulty level.
- * 2. For levels 1–2, generates a valid grid dynamically and removes cells while ensuring uniqueness.
- * 3. For levels 3–4, selects a random pre-generated seed puzzle, applies random transformations, and ensures it adheres to the desired level.
- *    This is because generating hard puzzles on the fly could be computationally intensive, making the user experience slow.
- * 4. Outputs the generated puzzle and writes it to a file if it matches the input level.
+ * Parameters:
+ * - arg: Pointer to the `DigCandidate` to be evaluated.
+ */
+static void evaluate_candidate(void *arg) {
+    TRACE_SCOPE("evaluate_candidate");
+    DigCandidate *candidate = arg;
+    SolverStats temp_stats = {0};
+    Sudoku temp_sudoku;
+
+    candidate->unique = false;
+    memcpy(&temp_sudoku, &candidate->sudoku, sizeof(Sudoku));
+    if(!solve_human(&temp_sudoku, &temp_stats, false, candidate->output_path)) {
+        return;
+    }
+    memcpy(&temp_sudoku, &candidate->sudoku, sizeof(Sudoku));
+    if(count_solutions(&temp_sudoku, time(NULL)) != 1) {
+        return;
+    }
+    candidate->unique = true;
+    candidate->assessed_level = stats_level(&temp_stats);
+    candidate->score = stats_score(&temp_stats);
+}
 
- * Returns:
- * - 0 on successful execution, or an error code for invalid inputs.
+
+/**
+ * Function: parallel_dig
+ * ----------------------
+ * Parallel variant of `dynamic_dig`. At each round a batch of filled cells is removed speculatively,
+ * the candidates are evaluated concurrently on the thread pool and the best one is committed:
+ * the candidate that reaches the desired level with the highest rating, without exceeding the level.
+ * Removing a cell never makes a puzzle easier or more constrained, so cells whose removal breaks
+ * uniqueness or overshoots the level are discarded for good instead of being drawn again.
+ * Accepted candidates that were not committed are put back and re-evaluated in a later round.
+ * Digging goes past `cell_bound` while the desired level has not been reached yet, which saves a
+ * full regeneration when the bound alone would produce a puzzle that is too easy.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid to be modified.
+ * - level: Desired difficulty level (1–4).
+ * - cell_bound: Minimum number of cells that must remain filled in the puzzle.
+ * - output_path: Path forwarded to the human solver.
+ * - pool: Thread pool running the evaluations, or NULL to evaluate them on the calling thread.
+ * - n_candidates: Number of removals evaluated at each round.
+ * - rng: Pointer to the random generator of the calling context. Only the calling thread draws from it,
+ *   so the result depends on the seed and on `n_candidates` but not on the scheduling of the workers.
  */
-int main(
-    int argc,
-    char *argv[]
+void parallel_dig(
+    Sudoku *sudoku,
+    int level,
+    int cell_bound,
+    char *output_path,
+    ThreadPool *pool,
+    int n_candidates,
+    Rng *rng
 ) {
-    if(argc != 4) {
-        printf("Usage: %s <level> <seeds_path> <output_path>\n", argv[0]);
-        return 1;
+    TRACE_SCOPE("parallel_dig");
+    DigCandidate *candidates = malloc(n_candidates * sizeof(DigCandidate));
+    if(candidates == NULL) {
+        dynamic_dig(sudoku, level, cell_bound, output_path, rng);
+        return;
     }
-    srand(time(NULL));
-    Sudoku sudoku;
-    SolverStats stats = {0};
-    memset(sudoku.table, 0, sizeof(sudoku.table));
 
-    // Grab and validate the input level
-    int level = atoi(argv[1]);
-    if(level < 1 || level > 4) {
-        printf("Invalid level! Please enter a value between 1 and 4.\n");
-        return 1;
+    // Shuffle the filled cells that are still worth trying
+    int untested[N*N];
+    int n_untested = 0;
+    for(int cell = 0; cell < N*N; cell++) {
+        if(sudoku->table[cell / N][cell % N] != 0) {
+            untested[n_untested++] = cell;
+        }
+    }
+    for(int i = n_untested - 1; i > 0; i--) {
+        int j = rng_int(rng, i + 1);
+        int temp = untested[i];
+        untested[i] = untested[j];
+        untested[j] = temp;
     }
 
-    if(level <= 2) {
-        while (1) {
-            // Step 1: Generate a valid grid
-            // printf("\nGenerating a new valid grid...\n");
-            if(!generate_valid_grid(&sudoku)) {
-                // printf("Failed to generate a valid grid within the time limit. Running again...\n");
-                continue;
+    int total_givens = n_untested;
+    int current_level = 1;
+    while((total_givens > cell_bound || current_level < level) && n_untested > 0) {
+
+        // Step 1: Evaluate a batch of removals concurrently
+        int batch = (n_untested < n_candidates) ? n_untested : n_candidates;
+        for(int i = 0; i < batch; i++) {
+            int cell = untested[--n_untested];
+            DigCandidate *candidate = &candidates[i];
+            memcpy(&candidate->sudoku, sudoku, sizeof(Sudoku));
+            candidate->row = cell / N;
+            candidate->col = cell % N;
+            candidate->sudoku.table[candidate->row][candidate->col] = 0;
+            candidate->output_path = output_path;
+            if(pool != NULL) {
+                thread_pool_submit(pool, evaluate_candidate, candidate);
+            } else {
+                evaluate_candidate(candidate);
             }
-            // printf("\nGrid generated!\n");
-            random_transformations(&sudoku);
-
-            // Step 2: Dig
-            int cell_bound = sample_cells_bound(level);
-            // printf("\nStarting the digging procedure...\n");
-            dynamic_dig(&sudoku, level, cell_bound, argv[3]);
+        }
+        if(pool != NULL) {
+            thread_pool_wait(pool);
+        }
 
-            // Step 3: Check if the puzzle meets the desired criteria
-            int total_givens = 0;
-            for(int i = 0; i < N; i++) {
-                for(int j = 0; j < N; j++) {
-                    if(sudoku.table[i][j] != 0) {
-                        total_givens++;
-                    }
-                }
-            }
-            if(total_givens > cell_bound) {
-                continue;
+        // Step 2: Pick the best candidate that does not exceed the desired level
+        int best = -1;
+        for(int i = 0; i < batch; i++) {
+            if(!candidates[i].unique || candidates[i].assessed_level > level) continue;
+            if(best == -1
+                || (candidates[i].assessed_level == level) > (candidates[best].assessed_level == level)
+                || ((candidates[i].assessed_level == level) == (candidates[best].assessed_level == level)
+                    && candidates[i].score > candidates[best].score)) {
+                best = i;
             }
+        }
 
-            SolverStats stats = {0};
-            int assessed_level = assess_level(&sudoku, &stats, level, argv[3]);
-            if(assessed_level == level) {
-                // printf("Generated puzzle matches desired level %d.\nStats:\n", level);
-                // print_stats(&stats);
-                break;
-            } else if(assessed_level == -1) {
-                // printf("Unsolvable puzzle, re-generating...\n");
-                continue;
-            } else {
-                // printf("Level mismatch, re-generating...\n");
-                continue;
-            }
+        // Step 3: Put back the runners-up and commit the best removal
+        for(int i = 0; i < batch; i++) {
+            if(i == best || !candidates[i].unique || candidates[i].assessed_level > level) continue;
+            int j = rng_int(rng, n_untested + 1);
+            untested[n_untested++] = untested[j];
+            untested[j] = candidates[i].row * N + candidates[i].col;
         }
-    } else {
-        while (1) {
-
-            // Step 1: Select a random seed puzzle for levels 3 and 4
-            const char** seed_files = (level == 3) ? level_3_seeds : level_4_seeds;
-            int seed_count = (level == 3) ? sizeof(level_3_seeds) / sizeof(level_3_seeds[0]) : sizeof(level_4_seeds) / sizeof(level_4_seeds[0]);
-            int random_index = rand() % seed_count;
-            char file_path[256];
-            sprintf(file_path, "%s\\%s", argv[2], seed_files[random_index]);
-            parse_file(&sudoku, file_path);
-
-            // Step 2: Apply random transformations
-            random_transformations(&sudoku);
+        if(best == -1) continue;
+        sudoku->table[candidates[best].row][candidates[best].col] = 0;
+        total_givens--;
+        current_level = candidates[best].assessed_level;
+
+        // Stop as soon as the hard levels are reached, like `dynamic_dig`
+        if(level >= 3 && candidates[best].assessed_level >= level) {
+            break;
+        }
+    }
+    free(candidates);
+}
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- TARGETED GENERATION --- //
+
+
+/**
+ * Function: targeted_generate
+ * ---------------------------
+ * Searches for a puzzle whose human solve requires the techniques of the desired level, starting from a fresh grid
+ * instead of a seed puzzle. Used for levels 3–4.
+ * The search climbs on the set of givens: at each step `parallel_dig` scores several removals with the human solver
+ * and keeps the best one, among the removals after which the puzzle is still unique and human solvable without
+ * exceeding the level, and it stops as soon as the human solve profile needs a technique of the desired level
+ * (triples for level 3, X-Wing for level 4). At least TARGETED_CANDIDATES removals are scored per step: a narrower
+ * climb is cheaper per attempt but reaches the level so much less often that it finds fewer puzzles per second.
+ * When the climb gets stuck on a minimal puzzle that is still too easy, the attempt fails: restarting from a new grid
+ * turned out to yield more hard puzzles per second than perturbing the givens of a stuck puzzle.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid receiving the puzzle.
+ * - level: Desired difficulty level (1–4).
+ * - output_path: Path forwarded to the human solver.
+ * - pool: Thread pool scoring the removals, or NULL to score them on the calling thread.
+ * - n_candidates: Number of removals scored at each step, raised to TARGETED_CANDIDATES.
+ * - rng: Pointer to the random generator of the calling context.
+
+ * Returns:
+ * - true if a puzzle of the desired level was found, false otherwise.
+ */
+bool targeted_generate(
+    Sudoku *sudoku,
+    int level,
+    char *output_path,
+    ThreadPool *pool,
+    int n_candidates,
+    Rng *rng
+) {
+    TRACE_SCOPE("targeted_generate");
+    memset(sudoku->table, 0, sizeof(sudoku->table));
+    if(!generate_valid_grid(sudoku, rng)) {
+        return false;
+    }
+    random_transformations(sudoku, rng);
+
+    // Climb until the level is reached or no given can be removed
+    int width = (n_candidates > TARGETED_CANDIDATES) ? n_candidates : TARGETED_CANDIDATES;
+    parallel_dig(sudoku, level, 0, output_path, pool, width, rng);
+
+    DigCandidate result;
+    memcpy(&result.sudoku, sudoku, sizeof(Sudoku));
+    result.output_path = output_path;
+    evaluate_candidate(&result);
+    return result.unique && result.assessed_level == level;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- PUZZLE GENERATION --- //
+
+
+/**
+ * Function: generate_puzzle
+ * -------------------------
+ * Generates one puzzle of the desired level.
+ * Levels 1–2 are generated dynamically using a structured digging process.
+ * Levels 3–4 are searched with `targeted_generate`. Since hard puzzles can take a while to find, after TARGETED_ATTEMPTS
+ * failed attempts each seed puzzle of the bank is tried once with random transformations before searching again,
+ * up to TARGETED_RETRIES times.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid receiving the puzzle.
+ * - level: Desired difficulty level (1–4).
+ * - seeds: Seed bank loaded at startup (may be empty).
+ * - output_path: Path forwarded to the human solver.
+ * - solving_mode: Whether to record the moves needed to solve the final puzzle in the log file.
+ * - pool: Thread pool used to dig in parallel, or NULL to evaluate the removals on the calling thread.
+ * - n_candidates: Number of removals evaluated at each round of `parallel_dig`, or 0 to use `dynamic_dig`
+ *   (levels 3–4 always use `parallel_dig`).
+ * - rng: Pointer to the random generator of the calling context.
+
+ * Returns:
+ * - true if a puzzle was generated, false if no puzzle of level 3–4 was found within the retries.
+ */
+bool generate_puzzle(
+    Sudoku *sudoku,
+    int level,
+    const SeedBank *seeds,
+    char *output_path,
+    bool solving_mode,
+    ThreadPool *pool,
+    int n_candidates,
+    Rng *rng
+) {
+    TRACE_SCOPE_ARG("generate_puzzle", "level", level);
+    memset(sudoku->table, 0, sizeof(sudoku->table));
+
+    if(level <= 2) {
+        for(int retry = 0; ; retry++) {
+            TRACE_SCOPE_ARG("retry", "retry", retry);
+
+            // Step 1: Generate a valid grid
+            // printf("\nGenerating a new valid grid...\n");
+            if(!generate_valid_grid(sudoku, rng)) {
+                // printf("Failed to generate a valid grid within the time limit. Running again...\n");
+                continue;
+            }
+            // printf("\nGrid generated!\n");
+            random_transformations(sudoku, rng);
+
+            // Step 2: Dig
+            int cell_bound = sample_cells_bound(level, rng);
+            // printf("\nStarting the digging procedure...\n");
+            if(n_candidates > 0) {
+                parallel_dig(sudoku, level, cell_bound, output_path, pool, n_candidates, rng);
+            } else {
+                dynamic_dig(sudoku, level, cell_bound, output_path, rng);
+            }
+
+            // Step 3: Check if the puzzle meets the desired criteria
+            int total_givens = 0;
+            for(int i = 0; i < N; i++) {
+                for(int j = 0; j < N; j++) {
+                    if(sudoku->table[i][j] != 0) {
+                        total_givens++;
+                    }
+                }
+            }
+            if(total_givens > cell_bound) {
+                continue;
+            }
+
             SolverStats stats = {0};
-            int assessed_level = assess_level(&sudoku, &stats, level, argv[3]);
+            int assessed_level = assess_level(sudoku, &stats, level, solving_mode, output_path);
             if(assessed_level == level) {
                 // printf("Generated puzzle matches desired level %d.\nStats:\n", level);
                 // print_stats(&stats);
-                break;
-            }else if(assessed_level == -1) {
+                return true;
+            } else if(assessed_level == -1) {
                 // printf("Unsolvable puzzle, re-generating...\n");
-                // print_stats(&stats);
-                break;
+                continue;
             } else {
                 // printf("Level mismatch, re-generating...\n");
                 continue;
             }
         }
+    } else {
+        int seed_count = seed_bank_count(seeds, level);
+        for(int retry = 0; retry < TARGETED_RETRIES; retry++) {
+            TRACE_SCOPE_ARG("retry", "retry", retry);
+
+            // Step 1: Search for a puzzle that requires the techniques of the level
+            for(int attempt = 0; attempt < TARGETED_ATTEMPTS; attempt++) {
+                TRACE_SCOPE_ARG("targeted_attempt", "attempt", attempt);
+                if(targeted_generate(sudoku, level, output_path, pool, n_candidates, rng)) {
+                    SolverStats stats = {0};
+                    if(assess_level(sudoku, &stats, level, solving_mode, output_path) == level) {
+                        return true;
+                    }
+                }
+            }
+
+            // Step 2: Fall back to the seed puzzles, trying each of them once in random order
+            TRACE_SCOPE("seed_fallback");
+            int order[MAX_SEEDS_PER_LEVEL];
+            for(int i = 0; i < seed_count; i++) {
+                order[i] = i;
+            }
+            for(int i = seed_count - 1; i > 0; i--) {
+                int j = rng_int(rng, i + 1);
+                int temp = order[i];
+                order[i] = order[j];
+                order[j] = temp;
+            }
+            for(int i = 0; i < seed_count; i++) {
+                memcpy(sudoku, seed_bank_get(seeds, level, order[i]), sizeof(Sudoku));
+
+                // Apply random transformations
+                random_transformations(sudoku, rng);
+                SolverStats stats = {0};
+                int assessed_level = assess_level(sudoku, &stats, level, solving_mode, output_path);
+                if(assessed_level == level) {
+                    // printf("Generated puzzle matches desired level %d.\nStats:\n", level);
+                    // print_stats(&stats);
+                    return true;
+                }
+                // printf("Level mismatch or unsolvable puzzle, trying the next seed...\n");
+            }
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Function: generate_new_puzzle
+ * -----------------------------
+ * Generates puzzles with `generate_puzzle` until one is not in the puzzle store yet (up to symmetry),
+ * then records it in the store with its level and the techniques needed to solve it.
+ * Without a store this is just `generate_puzzle`.
+
+ * Parameters:
+ * - store: Puzzle store to consult, or NULL.
+ * - The others are forwarded to `generate_puzzle`.
+
+ * Returns:
+ * - false if `generate_puzzle` failed, true otherwise.
+ */
+bool generate_new_puzzle(
+    PuzzleStore *store,
+    Sudoku *sudoku,
+    int level,
+    const SeedBank *seeds,
+    char *output_path,
+    bool solving_mode,
+    ThreadPool *pool,
+    int n_candidates,
+    Rng *rng
+) {
+    for(int attempt = 1; ; attempt++) {
+        TRACE_SCOPE_ARG("store_attempt", "attempt", attempt);
+        if(!generate_puzzle(sudoku, level, seeds, output_path, solving_mode, pool, n_candidates, rng)) {
+            return false;
+        }
+        if(store == NULL) {
+            return true;
+        }
+
+        SolverStats stats = {0};
+        Sudoku sudoku_copy;
+        memcpy(&sudoku_copy, sudoku, sizeof(Sudoku));
+        solve_human(&sudoku_copy, &stats, false, output_path);
+        if(store_add(store, sudoku, level, &stats)) {
+            return true;
+        }
+        // printf("Puzzle already in the store, re-generating...\n");
+    }
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- BATCH GENERATION --- //
+
+
+/**
+ * Struct: BatchJob
+ * ----------------
+ * State shared by the workers of a batch run.
+ *
+ * Fields:
+ * - store, level, seeds, output_path: Arguments forwarded to `generate_new_puzzle`.
+ * - n_puzzles: Number of puzzles to be generated.
+ * - n_claimed: Number of puzzles already claimed by a worker.
+ * - n_written: Number of puzzles already written, in order, to the output.
+ * - seed: Base seed of the run. Puzzle i is generated from its own stream derived from (seed, i).
+ * - puzzles: Puzzles that are ready but may still be waiting for the previous ones to be written.
+ * - ready: Whether each entry of `puzzles` holds a puzzle.
+ * - failed: Whether a puzzle could not be generated, which stops the batch.
+ * - out: Stream receiving the puzzles, one per line.
+ * - lock: Protects the counters, the pending lines and the output stream.
+ */
+typedef struct {
+    PuzzleStore *store;
+    int level;
+    const SeedBank *seeds;
+    char *output_path;
+    int n_puzzles;
+    int n_claimed;
+    int n_written;
+    uint64_t seed;
+    Sudoku *puzzles;
+    bool *ready;
+    bool failed;
+    FILE *out;
+    pthread_mutex_t lock;
+} BatchJob;
+
+
+/**
+ * Function: batch_worker
+ * ----------------------
+ * Task run on the thread pool: generates puzzles until the batch is complete.
+ * Every puzzle is generated with its own random generator seeded from its index, and every worker
+ * digs serially with its own human solver candidates, so the output only depends on the seed.
+ * Puzzles are streamed to the output as soon as all the previous ones have been written.
+
+ * Parameters:
+ * - arg: Pointer to the `BatchJob` being processed.
+ */
+static void batch_worker(void *arg) {
+    BatchJob *job = arg;
+    Sudoku sudoku;
+    Rng rng;
+
+    while (true) {
+        pthread_mutex_lock(&job->lock);
+        if(job->failed || job->n_claimed == job->n_puzzles) {
+            pthread_mutex_unlock(&job->lock);
+            return;
+        }
+        int index = job->n_claimed++;
+        pthread_mutex_unlock(&job->lock);
+
+        rng_seed(&rng, job->seed + 0x9E3779B97F4A7C15ULL * (uint64_t)index);
+        bool generated = generate_new_puzzle(job->store, &sudoku, job->level, job->seeds, job->output_path, false, NULL, 1, &rng);
+
+        pthread_mutex_lock(&job->lock);
+        if(!generated) {
+            job->failed = true;
+            pthread_mutex_unlock(&job->lock);
+            return;
+        }
+        job->puzzles[index] = sudoku;
+        job->ready[index] = true;
+        while(job->n_written < job->n_puzzles && job->ready[job->n_written]) {
+            write_line(&job->puzzles[job->n_written], job->out);
+            job->n_written++;
+        }
+        fflush(job->out);
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+
+/**
+ * Function: generate_batch
+ * ------------------------
+ * Generates several puzzles of the same level across all the threads of the pool.
+
+ * Parameters:
+ * - job: Pointer to the `BatchJob` describing the run.
+ * - pool: Thread pool running the workers.
+ * - n_threads: Number of workers to start.
+ *
+ * Returns:
+ * - true on success, false if the buffers could not be allocated.
+ *   A puzzle that could not be generated stops the batch and sets `job->failed`: the puzzles before it are written.
+ */
+bool generate_batch(
+    BatchJob *job,
+    ThreadPool *pool,
+    int n_threads
+) {
+    job->puzzles = malloc(job->n_puzzles * sizeof(Sudoku));
+    job->ready = calloc(job->n_puzzles, sizeof(bool));
+    if(job->puzzles == NULL || job->ready == NULL) {
+        free(job->puzzles);
+        free(job->ready);
+        return false;
+    }
+
+    pthread_mutex_init(&job->lock, NULL);
+    for(int i = 0; i < n_threads; i++) {
+        thread_pool_submit(pool, batch_worker, job);
+    }
+    thread_pool_wait(pool);
+    pthread_mutex_destroy(&job->lock);
+
+    free(job->puzzles);
+    free(job->ready);
+    return true;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- VARIANT EXPANSION --- //
+
+
+/**
+ * Struct: Variant
+ * ---------------
+ * A transformed copy of the seed puzzle, verified by a worker thread.
+ *
+ * Fields:
+ * - transform: Transformation drawn on the calling thread before the round starts.
+ * - seed: Pointer to the seed puzzle.
+ * - sudoku: Transformed puzzle.
+ * - level: Desired difficulty level.
+ * - output_path: Path forwarded to the human solver.
+ * - verified: Whether the human solver confirms the desired level.
+ */
+typedef struct {
+    Transform transform;
+    const Sudoku *seed;
+    Sudoku sudoku;
+    int level;
+    char *output_path;
+    bool verified;
+} Variant;
+
+
+/**
+ * Function: verify_variant
+ * ------------------------
+ * Task run on the thread pool: applies the transformation of a variant and assesses its level.
+
+ * Parameters:
+ * - arg: Pointer to the `Variant` being verified.
+ */
+static void verify_variant(void *arg) {
+    Variant *variant = arg;
+    SolverStats stats = {0};
+
+    transform_apply(&variant->transform, variant->seed, &variant->sudoku);
+    variant->verified = assess_level(&variant->sudoku, &stats, variant->level, false, variant->output_path) == variant->level;
+}
+
+
+/**
+ * Function: hash_puzzle
+ * ---------------------
+ * FNV-1a hash of the 81 cells of a puzzle, used to detect duplicate variants.
+ */
+static uint64_t hash_puzzle(const Sudoku *sudoku) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(int i = 0; i < N; i++) {
+        for(int j = 0; j < N; j++) {
+            hash = (hash ^ (uint64_t)sudoku->table[i][j]) * 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+
+/**
+ * Function: generate_variants
+ * ---------------------------
+ * Expands a seed puzzle into distinct transformed variants of the same level.
+ * Each round draws the transformations still needed on the calling thread, verifies them concurrently on
+ * the thread pool, and then emits the verified ones in draw order, skipping the variants already emitted.
+ * Duplicates are tracked in an open-addressing table of the emitted puzzles.
+ * Rounds stop when `n_variants` puzzles are emitted or when a whole round adds nothing, which happens when
+ * the seed is not of the desired level.
+
+ * Parameters:
+ * - seed_puzzle: Pointer to the seed puzzle.
+ * - level: Level every variant must be verified to have.
+ * - n_variants: Number of distinct variants to emit.
+ * - output_path: Path forwarded to the human solver.
+ * - pool: Thread pool running the verifications.
+ * - rng: Pointer to the random generator drawing the transformations.
+ * - out: Stream receiving the variants, one per line.
+ *
+ * Returns:
+ * - The number of variants emitted, or -1 if the buffers could not be allocated.
+ */
+int generate_variants(
+    const Sudoku *seed_puzzle,
+    int level,
+    int n_variants,
+    char *output_path,
+    ThreadPool *pool,
+    Rng *rng,
+    FILE *out
+) {
+    // The table holds the emitted puzzles and stays at most half full
+    int capacity = 16;
+    while(capacity < 2 * n_variants) {
+        capacity *= 2;
+    }
+    Sudoku *emitted = malloc(n_variants * sizeof(Sudoku));
+    int *slots = malloc(capacity * sizeof(int));
+    Variant *variants = malloc(n_variants * sizeof(Variant));
+    if(emitted == NULL || slots == NULL || variants == NULL) {
+        free(emitted);
+        free(slots);
+        free(variants);
+        return -1;
+    }
+    for(int i = 0; i < capacity; i++) {
+        slots[i] = -1;
+    }
+
+    int n_emitted = 0;
+    while(n_emitted < n_variants) {
+
+        // Draw the transformations of the round, then verify them in parallel
+        int n_round = n_variants - n_emitted;
+        for(int i = 0; i < n_round; i++) {
+            transform_random(&variants[i].transform, rng);
+            variants[i].seed = seed_puzzle;
+            variants[i].level = level;
+            variants[i].output_path = output_path;
+            thread_pool_submit(pool, verify_variant, &variants[i]);
+        }
+        thread_pool_wait(pool);
+
+        // Emit the new verified variants
+        int n_before = n_emitted;
+        for(int i = 0; i < n_round; i++) {
+            if(!variants[i].verified) continue;
+
+            int slot = hash_puzzle(&variants[i].sudoku) & (capacity - 1);
+            while(slots[slot] != -1 && memcmp(&emitted[slots[slot]], &variants[i].sudoku, sizeof(Sudoku)) != 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if(slots[slot] != -1) continue;
+
+            slots[slot] = n_emitted;
+            emitted[n_emitted++] = variants[i].sudoku;
+            write_line(&variants[i].sudoku, out);
+        }
+        fflush(out);
+        if(n_emitted == n_before) break;
+    }
+
+    free(emitted);
+    free(slots);
+    free(variants);
+    return n_emitted;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- PUZZLE POOL --- //
+
+
+/**
+ * Function: serve_from_pool
+ * -------------------------
+ * Takes a ready puzzle of the desired level from the pool file, without generating anything.
+
+ * Parameters:
+ * - pool_file: Path to the pool file.
+ * - level: Desired difficulty level (1–4).
+ * - sudoku: Pointer to the Sudoku grid receiving the puzzle.
+ *
+ * Returns:
+ * - true if a puzzle was served, false if the pool of the level is empty or unavailable.
+ */
+bool serve_from_pool(
+    const char *pool_file,
+    int level,
+    Sudoku *sudoku
+) {
+    PuzzlePool *pool = malloc(sizeof(PuzzlePool));
+    int lock = puzzle_pool_lock(pool_file, ".lock", true);
+    if(pool == NULL || lock < 0) {
+        free(pool);
+        puzzle_pool_unlock(lock);
+        return false;
+    }
+
+    bool served = false;
+    if(puzzle_pool_load(pool, pool_file) && puzzle_pool_take(pool, level, sudoku)) {
+        served = puzzle_pool_save(pool, pool_file);
+    }
+    puzzle_pool_unlock(lock);
+    free(pool);
+    return served;
+}
+
+
+/**
+ * Function: refill_pool
+ * ---------------------
+ * Refills the pool of a level up to its capacity once it went below the low-water mark.
+ * Meant to run in the background: only one refill runs at a time per pool file, and puzzles are added
+ * one by one, each under the pool lock, so that serving is never blocked by the generation.
+
+ * Parameters:
+ * - pool_file: Path to the pool file.
+ * - store: Puzzle store to consult, or NULL.
+ * - The others are forwarded to `generate_new_puzzle`.
+ *
+ * Returns:
+ * - false if the pool could not be read or written or a puzzle could not be generated, true otherwise.
+ */
+bool refill_pool(
+    const char *pool_file,
+    PuzzleStore *store,
+    int level,
+    const SeedBank *seeds,
+    char *output_path,
+    ThreadPool *thread_pool,
+    int n_candidates,
+    Rng *rng
+) {
+    // Another process is already refilling this pool
+    int refill_lock = puzzle_pool_lock(pool_file, ".refill", false);
+    if(refill_lock < 0) {
+        return true;
+    }
+    PuzzlePool *pool = malloc(sizeof(PuzzlePool));
+    if(pool == NULL) {
+        puzzle_pool_unlock(refill_lock);
+        return false;
+    }
+
+    bool ok = true, refilling = false;
+    while (ok) {
+        Sudoku sudoku;
+        if(refilling && !generate_new_puzzle(store, &sudoku, level, seeds, output_path, false, thread_pool, n_candidates, rng)) {
+            ok = false;
+            break;
+        }
+
+        int lock = puzzle_pool_lock(pool_file, ".lock", true);
+        ok = lock >= 0 && puzzle_pool_load(pool, pool_file);
+        if(ok && refilling) {
+            ok = puzzle_pool_put(pool, level, &sudoku) && puzzle_pool_save(pool, pool_file);
+        }
+        bool done = !ok || puzzle_pool_is_full(pool, level) || (!refilling && !puzzle_pool_needs_refill(pool, level));
+        puzzle_pool_unlock(lock);
+        if(done) break;
+        refilling = true;
+    }
+
+    free(pool);
+    puzzle_pool_unlock(refill_lock);
+    return ok;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- MAIN FUNCTION --- //
+
+
+// The shared library (libsudoku.so) is built without the entry points
+#ifndef SUDOKU_LIBRARY
+
+/**
+ * Function: server_main
+ * ---------------------
+ * Entry point of the server mode: loads the shared resources once and serves the requests.
+
+ * Parameters:
+ * - argc, argv: Command-line arguments, starting with `--serve <seeds_path>`.
+ * - usage: Usage message printed on invalid arguments.
+ *
+ * Returns:
+ * - 0 when the input ends, or an error code for invalid inputs.
+ */
+int server_main(
+    int argc,
+    char *argv[],
+    const char *usage
+) {
+    char *socket_path = NULL;
+    char *store_file = NULL;
+    ServerConfig config = {.seed = (uint64_t)time(NULL)};
+    for(int i = 3; i < argc; i++) {
+        if(strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if(strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            store_file = argv[++i];
+        } else if(strcmp(argv[i], "--pool") == 0 && i + 1 < argc) {
+            config.pool_file = argv[++i];
+        } else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if(!trace_open(argv[++i])) {
+                printf("Error creating the trace file '%s'\n", argv[i]);
+                return 1;
+            }
+        } else {
+            printf(usage, argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    static SeedBank seeds;
+    seed_bank_load(&seeds, argv[2]);
+    config.seeds = &seeds;
+    if(store_file != NULL) {
+        config.store = store_open(store_file);
+        if(config.store == NULL) {
+            printf("Error opening the puzzle store '%s'\n", store_file);
+            return 1;
+        }
+    }
+
+    int result = (socket_path != NULL) ? serve_socket(socket_path, &config) : serve_stream(stdin, stdout, &config, 0);
+    store_close(config.store);
+    return result;
+}
+
+
+/**
+ * Function: main
+ * --------------
+ * Entry point for the Sudoku generator program. Handles puzzle generation for difficulty levels 1–4.
+
+ * Key Steps:
+ * 1. Accepts user input for the desired difficulty level.
+ * 2. Generates a puzzle with `generate_puzzle`.
+ *    With `--threads N` (default: number of cores) several removals are evaluated concurrently at each step.
+ * 3. Outputs the generated puzzle and writes it to a file if it matches the input level.
+ *
+ * With `--count N` the program runs in batch mode instead: N puzzles are generated in parallel,
+ * one per thread at a time, and streamed in the 81-character line format to the file given with
+ * `--out` (stdout by default or with `--out -`).
+ *
+ * With `--variants K --from FILE` the program expands the seed puzzle in FILE instead: K distinct transformed
+ * variants, each verified to be of the input level, are written in the same line format.
+ *
+ * With `--store FILE` every emitted puzzle is recorded in a persistent puzzle store, and puzzles equivalent to
+ * one already stored are re-generated instead of being emitted (except in variant mode, whose output is
+ * equivalent to the seed by design).
+ *
+ * With `--pool FILE` the puzzle is served instantly from a pool of puzzles generated ahead of time, when the pool
+ * of the level is not empty. With `--pool FILE --refill` the program refills the pool of the level instead, once it
+ * went below its low-water mark, and is meant to be started in the background after serving.
+ *
+ * With `--serve` the program runs as a server instead, answering line requests (see server.c) on the standard
+ * input, or on the Unix socket given with `--socket`, until the input ends.
+ *
+ * With `--seed S` the run is reproducible: the same seed gives the same puzzles
+ * (in single mode, for the same number of threads).
+ *
+ * With `--trace FILE` the phases of the run (grid generation, digging, uniqueness counting, level assessment,
+ * retries...) are recorded as a Chrome trace-event JSON file (see trace.c), to be opened in a trace viewer.
+
+ * Returns:
+ * - 0 on successful execution, or an error code for invalid inputs.
+ */
+int main(
+    int argc,
+    char *argv[]
+) {
+    const char *usage = "Usage: %s <level> <seeds_path> <output_path> [--threads N] [--count N] [--out FILE] [--seed S] [--variants K --from FILE] [--store FILE] [--pool FILE [--refill]] [--trace FILE]\n"
+                        "       %s --serve <seeds_path> [--socket PATH] [--store FILE] [--pool FILE] [--seed S] [--trace FILE]\n";
+    if(argc >= 3 && strcmp(argv[1], "--serve") == 0) {
+        return server_main(argc, argv, usage);
+    }
+    if(argc < 4) {
+        printf(usage, argv[0], argv[0]);
+        return 1;
+    }
+
+    // Parse the optional arguments
+    int n_threads = thread_pool_default_size();
+    int n_puzzles = 0;
+    int n_variants = 0;
+    char *seed_file = NULL;
+    char *store_file = NULL;
+    char *pool_file = NULL;
+    bool refill = false;
+    char *batch_file = "-";
+    char *trace_file = NULL;
+    uint64_t seed = (uint64_t)time(NULL);
+    for(int i = 4; i < argc; i++) {
+        if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            n_threads = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            n_puzzles = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            batch_file = argv[++i];
+        } else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if(strcmp(argv[i], "--variants") == 0 && i + 1 < argc) {
+            n_variants = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            seed_file = argv[++i];
+        } else if(strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            store_file = argv[++i];
+        } else if(strcmp(argv[i], "--pool") == 0 && i + 1 < argc) {
+            pool_file = argv[++i];
+        } else if(strcmp(argv[i], "--refill") == 0) {
+            refill = true;
+        } else if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else {
+            printf(usage, argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if((n_variants > 0) != (seed_file != NULL) || (refill && pool_file == NULL)) {
+        printf(usage, argv[0], argv[0]);
+        return 1;
+    }
+    if(trace_file != NULL && !trace_open(trace_file)) {
+        printf("Error creating the trace file '%s'\n", trace_file);
+        return 1;
+    }
+    Sudoku sudoku;
+    Rng rng;
+    rng_seed(&rng, seed);
+
+    // Grab and validate the input level
+    int level = atoi(argv[1]);
+    if(level < 1 || level > 4) {
+        printf("Invalid level! Please enter a value between 1 and 4.\n");
+        return 1;
+    }
+
+    // The puzzle to expand into variants is read up front, so a malformed file stops the run before any work
+    if(n_variants > 0) {
+        ParseResult parsed = parse_file(&sudoku, seed_file);
+        if(parsed.error != PARSE_OK) {
+            report_parse_error(seed_file, parsed);
+            return 1;
+        }
+    }
+
+    // Load the seed puzzles once, generation only works in memory afterwards
+    static SeedBank seeds;
+    seed_bank_load(&seeds, argv[2]);
+
+    // Puzzles already in the store are never emitted again
+    PuzzleStore *store = NULL;
+    if(store_file != NULL) {
+        store = store_open(store_file);
+        if(store == NULL) {
+            printf("Error opening the puzzle store '%s'\n", store_file);
+            return 1;
+        }
+    }
+
+    // Batch and variant modes: stream several puzzles to a single output
+    if(n_puzzles > 0 || n_variants > 0) {
+        FILE *out = stdout;
+        if(strcmp(batch_file, "-") != 0) {
+            out = fopen(batch_file, "w");
+            if(out == NULL) {
+                printf("Error creating file '%s'\n", batch_file);
+                store_close(store);
+                return 1;
+            }
+        }
+        ThreadPool *pool = thread_pool_create(n_threads);
+        if(pool == NULL) {
+            printf("Error starting the worker threads\n");
+            store_close(store);
+            return 1;
+        }
+
+        bool generated, failed = false;
+        if(n_variants > 0) {
+            int n_emitted = generate_variants(&sudoku, level, n_variants, argv[3], pool, &rng, out);
+            generated = n_emitted >= 0;
+            if(generated && n_emitted < n_variants) {
+                fprintf(stderr, "Only %d variants of level %d could be generated from '%s'\n", n_emitted, level, seed_file);
+            }
+        } else {
+            BatchJob job = {
+                .store = store,
+                .level = level,
+                .seeds = &seeds,
+                .output_path = argv[3],
+                .n_puzzles = n_puzzles,
+                .seed = seed,
+                .out = out
+            };
+            generated = generate_batch(&job, pool, n_threads);
+            failed = job.failed;
+        }
+        thread_pool_destroy(pool);
+        store_close(store);
+        if(out != stdout) {
+            fclose(out);
+        }
+        if(!generated) {
+            printf("Error allocating the batch buffers\n");
+            return 1;
+        }
+        if(failed) {
+            printf("Could not generate a puzzle of level %d\n", level);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Evaluate several removals at a time when more than one thread is available
+    ThreadPool *pool = (n_threads > 1) ? thread_pool_create(n_threads) : NULL;
+    int n_candidates = (pool != NULL) ? n_threads : 0;
+
+    // Refill mode: top up the pool of the level and exit
+    if(refill) {
+        bool refilled = refill_pool(pool_file, store, level, &seeds, argv[3], pool, (pool != NULL) ? n_candidates : 1, &rng);
+        thread_pool_destroy(pool);
+        store_close(store);
+        if(!refilled) {
+            printf("Error refilling the puzzle pool '%s'\n", pool_file);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Serve a ready puzzle when there is one, otherwise generate it now.
+    // With -DSOLVER_COUNTERS the searches run on this thread are counted and reported on stderr
+    // (the removals evaluated by the workers of `parallel_dig` are not).
+    SolverStats counters = {0};
+    counters_attach(&counters);
+    bool generated = true;
+    if(pool_file != NULL && serve_from_pool(pool_file, level, &sudoku)) {
+        SolverStats stats = {0};
+        assess_level(&sudoku, &stats, level, true, argv[3]);
+    } else {
+        generated = generate_new_puzzle(store, &sudoku, level, &seeds, argv[3], true, pool, n_candidates, &rng);
+    }
+    counters_attach(NULL);
+    print_counters(stderr, &counters);
+    thread_pool_destroy(pool);
+    store_close(store);
+    if(!generated) {
+        printf("Could not generate a puzzle of level %d\n", level);
+        return 1;
     }
 
     char output_file[256];
-    sprintf(output_file, "%s\\sudoku-gen.txt", argv[3]);
+    sprintf(output_file, "%s" PATH_SEPARATOR "sudoku-gen.txt", argv[3]);
     write_to_file(&sudoku, output_file);
     return 0;
 }
+
+#endif
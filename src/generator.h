@@ -0,0 +1,43 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "io.h"
+#include "rng.h"
+#include "seed_bank.h"
+#include "solver_bitmask.h"
+#include "solver_human.h"
+#include "store.h"
+#include "thread_pool.h"
+#include <stdbool.h>
+#include <time.h>
+
+int stats_level(SolverStats *stats);
+
+int assess_level(Sudoku *sudoku, SolverStats *stats, int input_level, bool solving_mode, char *output_path);
+
+bool generate_puzzle(
+    Sudoku *sudoku,
+    int level,
+    const SeedBank *seeds,
+    char *output_path,
+    bool solving_mode,
+    ThreadPool *pool,
+    int n_candidates,
+    Rng *rng
+);
+
+bool generate_new_puzzle(
+    PuzzleStore *store,
+    Sudoku *sudoku,
+    int level,
+    const SeedBank *seeds,
+    char *output_path,
+    bool solving_mode,
+    ThreadPool *pool,
+    int n_candidates,
+    Rng *rng
+);
+
+bool serve_from_pool(const char *pool_file, int level, Sudoku *sudoku);
+
+#endif
@@ -79,3 +79,33 @@ bool is_valid(
 
     return true;
 }
+
+
+/**
+ * Function: is_consistent
+ * -----------------------
+ * Check that no digit of the grid appears twice in the same row, column or box.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * 
+ * Returns:
+ * - true if the givens do not conflict,
+ *   false otherwise.
+ */
+bool is_consistent(Sudoku *sudoku) {
+    unsigned short masks[3][N] = {{0}};
+    for(int r = 0; r < N; r++) {
+        for(int c = 0; c < N; c++) {
+            if(sudoku->table[r][c] == 0) continue;
+            unsigned short bit = 1U << (sudoku->table[r][c] - 1);
+            if((masks[0][r] | masks[1][c] | masks[2][(r/3)*3 + c/3]) & bit) {
+                return false;
+            }
+            masks[0][r] |= bit;
+            masks[1][c] |= bit;
+            masks[2][(r/3)*3 + c/3] |= bit;
+        }
+    }
+    return true;
+}
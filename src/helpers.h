@@ -16,4 +16,6 @@ bool is_valid(
     int col
 );
 
+bool is_consistent(Sudoku *sudoku);
+
 #endif
\ No newline at end of file
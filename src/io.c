@@ -1,62 +1,192 @@
 #include "io.h"
 #include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 
 // ---------------------------------------------------------------------------------------------------- //
 // --- INPUT/OUTPUT FUNCTIONS --- //
 
 
+/**
+ * Function: parse_buffer
+ * ----------------------
+ * Parse a puzzle from a buffer in memory. The cells are read row by row as the characters '1'–'9',
+ * with '0' or '.' for the empty cells, while whitespace and the '|', '-' and '+' separators are skipped.
+ * This accepts the one-line format (with digits or dots), the space-separated grid written by
+ * `write_to_file` and the boxed grid printed by `print_table`.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure receiving the puzzle.
+ * - buffer: The characters to parse (not necessarily NUL-terminated).
+ * - length: Number of characters of the buffer.
+ * 
+ * Returns:
+ * - The outcome: PARSE_OK, or an error with the offset, line and column (starting at 1) where it was found
+ *   and the number of cells read until then.
+ */
+ParseResult parse_buffer(Sudoku *sudoku, const char *buffer, size_t length) {
+    ParseResult result = { PARSE_OK, 0, 1, 1, 0 };
+    int *cells = &sudoku->table[0][0];
+
+    for(size_t i = 0; i < length; i++) {
+        char ch = buffer[i];
+        if(ch == '\n') {
+            result.line++;
+            result.column = 1;
+            continue;
+        }
+        if(!isspace((unsigned char)ch) && ch != '|' && ch != '-' && ch != '+') {
+            if(ch != '.' && (ch < '0' || ch > '9')) {
+                result.error = PARSE_INVALID_CHARACTER;
+            } else if(result.cells == N*N) {
+                result.error = PARSE_TOO_MANY_CELLS;
+            }
+            if(result.error != PARSE_OK) {
+                result.offset = i;
+                return result;
+            }
+            cells[result.cells++] = (ch == '.') ? 0 : ch - '0';
+        }
+        result.column++;
+    }
+
+    result.offset = length;
+    if(result.cells < N*N) {
+        result.error = PARSE_TOO_FEW_CELLS;
+    }
+    return result;
+}
+
+
+/**
+ * Function: parse_error_message
+ * -----------------------------
+ * Describe a parsing error.
+ * 
+ * Parameters:
+ * - error: The error code.
+ * 
+ * Returns:
+ * - A constant string describing the error.
+ */
+const char *parse_error_message(ParseError error) {
+    switch(error) {
+        case PARSE_OK: return "no error";
+        case PARSE_CANNOT_OPEN: return "cannot open the file";
+        case PARSE_INVALID_CHARACTER: return "invalid character";
+        case PARSE_TOO_FEW_CELLS: return "fewer than 81 cells";
+        case PARSE_TOO_MANY_CELLS: return "more than 81 cells";
+        default: return "unknown error";
+    }
+}
+
+
+/**
+ * Function: report_parse_error
+ * ----------------------------
+ * Print a parsing error and its position on the standard error.
+ * 
+ * Parameters:
+ * - filename: Name of the file that was parsed.
+ * - result: The outcome of the parsing.
+ */
+void report_parse_error(const char *filename, ParseResult result) {
+    if(result.error == PARSE_CANNOT_OPEN) {
+        fprintf(stderr, "Error reading '%s': %s\n", filename, parse_error_message(result.error));
+    } else {
+        fprintf(stderr, "Error reading '%s' at line %d, column %d: %s (%d cells read)\n",
+                filename, result.line, result.column, parse_error_message(result.error), result.cells);
+    }
+}
+
+
 /**
  * Function: parse_file
  * --------------------
- * Parse an input file to populate the Sudoku grid.
+ * Parse an input file to populate the Sudoku grid, in any of the formats accepted by `parse_buffer`.
+ * The file is mapped in memory, so it can be of any size.
  * 
  * Parameters:
  * - sudoku: Pointer to the Sudoku structure.
  * - filename: Name of the file.
+ * 
+ * Returns:
+ * - The outcome of `parse_buffer`, or PARSE_CANNOT_OPEN if the file cannot be read.
  */
-void parse_file(Sudoku *sudoku, const char *filename) {
-    char file_str[1024];
-
-    // Open and read the file
-    FILE *file = fopen(filename, "r");
-    if(file == NULL) {
-        perror("Error opening file");
-        exit(1);
+ParseResult parse_file(Sudoku *sudoku, const char *filename) {
+    MappedFile file;
+    if(!map_file(&file, filename)) {
+        ParseResult result = { PARSE_CANNOT_OPEN, 0, 0, 0, 0 };
+        return result;
     }
-    size_t bytes_read = fread(file_str, sizeof(char), sizeof(file_str)-1, file);
-    file_str[bytes_read] = '\0';
-    fclose(file);
+    ParseResult result = parse_buffer(sudoku, file.data, file.size);
+    unmap_file(&file);
+    return result;
+}
 
-    // Parse the file
-    char *buffer = file_str;
-    int i = 0, j = 0;
-    while(*buffer) {
-        while(isspace(*buffer)) buffer++;
-        char *end;
-        int num = strtol(buffer, &end, 10);
-        if(num < 0 || num > 9) {
-            printf("Invalid number in file: %d\n", num);
-            exit(1);
-        }
 
-        sudoku->table[i][j] = num;
-        j++;
-        if(j == 9) {
-            j = 0;
-            i++;
+/**
+ * Function: parse_record
+ * ----------------------
+ * Parse a puzzle in the one-line format: 81 characters, row by row, with '0' or '.' for the empty cells.
+ * The puzzle may be followed by whitespace and further fields, which are ignored.
+ * The record does not need to be NUL-terminated, so it can be parsed in place from a mapped file.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - record: The characters of the record.
+ * - length: Number of characters of the record.
+ * 
+ * Returns:
+ * - true if the record holds a puzzle,
+ *   false otherwise.
+ */
+bool parse_record(Sudoku *sudoku, const char *record, size_t length) {
+    if(length < N*N) {
+        return false;
+    }
+    for(int i = 0; i < N*N; i++) {
+        char ch = record[i];
+        if(ch == '.' || ch == '0') {
+            sudoku->table[i / N][i % N] = 0;
+        } else if(ch >= '1' && ch <= '9') {
+            sudoku->table[i / N][i % N] = ch - '0';
+        } else {
+            return false;
         }
-        if(i == 9) break;
-        buffer = end;
     }
+    return length == N*N || isspace((unsigned char)record[N*N]);
+}
 
-    // Validate that the table is full
-    if (i != 9 || j != 0) {
-        printf("Error: File does not contain a complete 9x9 grid.\n");
-        exit(1);
-    }
+
+/**
+ * Function: parse_line
+ * --------------------
+ * Parse a NUL-terminated line in the one-line format (see `parse_record`).
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - line: The line to parse.
+ * 
+ * Returns:
+ * - true if the line holds a puzzle,
+ *   false otherwise.
+ */
+bool parse_line(Sudoku *sudoku, const char *line) {
+    return parse_record(sudoku, line, strnlen(line, N*N + 1));
 }
 
 
@@ -69,27 +199,8 @@ void parse_file(Sudoku *sudoku, const char *filename) {
  * - sudoku: Pointer to the Sudoku structure.
  */
 void print_table(Sudoku *sudoku) {
-    for(int i = 0; i < N; i++) {
-        
-        if(i == 0) {
-            printf("--------+-------+--------");
-            printf("\n");
-        }
-        for(int j = 0; j < N; j++) {
-            if(j == 0) {
-                printf("|");
-            }
-            printf(" %d", sudoku->table[i][j]);
-            if((j+1) % 3 == 0) {
-                printf(" |");
-            }
-        }
-        if((i+1) % 3 == 0) {
-            printf("\n");
-            printf("--------+-------+--------");
-        }
-        printf("\n");
-    }
+    char buffer[TABLE_TEXT_SIZE];
+    fwrite(buffer, 1, format_sudoku(sudoku, FORMAT_TABLE, buffer), stdout);
 }
 
 
@@ -112,11 +223,675 @@ void write_to_file(
         exit(1);
     }
 
-    for(int i = 0; i < N; i++) {
-        for(int j = 0; j < N; j++) {
-            fprintf(file, "%d ", sudoku->table[i][j]);
+    char buffer[GRID_TEXT_SIZE];
+    fwrite(buffer, 1, format_sudoku(sudoku, FORMAT_GRID, buffer), file);
+    fclose(file);
+}
+
+
+/**
+ * Function: write_line
+ * --------------------
+ * Write the Sudoku grid to an open stream as a single line of 81 digits (0 for empty cells).
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - file: Stream receiving the line.
+ */
+void write_line(
+    Sudoku *sudoku,
+    FILE *file
+) {
+    char buffer[LINE_TEXT_SIZE];
+    fwrite(buffer, 1, format_sudoku(sudoku, FORMAT_LINE, buffer), file);
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- OUTPUT FORMATTING --- //
+
+
+/******************************************************************************
+ * Output formats
+ * Grids are rendered into memory and written with a single call, instead of
+ * one formatted write per cell. The text formats copy a template holding the
+ * separators and store each digit at a position taken from lookup tables:
+ *
+ *     FORMAT_GRID   "7 0 4 6 0 2 0 0 0 \n" x 9 (as written by write_to_file)
+ *     FORMAT_TABLE  the boxed grid of print_table
+ *     FORMAT_LINE   81 digits and a newline
+ *     FORMAT_PACKED one record of the packed format, without the header
+ ******************************************************************************/
+
+
+static const char GRID_TEMPLATE[GRID_TEXT_SIZE + 1] =
+    "0 0 0 0 0 0 0 0 0 \n0 0 0 0 0 0 0 0 0 \n0 0 0 0 0 0 0 0 0 \n"
+    "0 0 0 0 0 0 0 0 0 \n0 0 0 0 0 0 0 0 0 \n0 0 0 0 0 0 0 0 0 \n"
+    "0 0 0 0 0 0 0 0 0 \n0 0 0 0 0 0 0 0 0 \n0 0 0 0 0 0 0 0 0 \n";
+
+static const char TABLE_TEMPLATE[TABLE_TEXT_SIZE + 1] =
+    "--------+-------+--------\n"
+    "| 0 0 0 | 0 0 0 | 0 0 0 |\n| 0 0 0 | 0 0 0 | 0 0 0 |\n| 0 0 0 | 0 0 0 | 0 0 0 |\n"
+    "--------+-------+--------\n"
+    "| 0 0 0 | 0 0 0 | 0 0 0 |\n| 0 0 0 | 0 0 0 | 0 0 0 |\n| 0 0 0 | 0 0 0 | 0 0 0 |\n"
+    "--------+-------+--------\n"
+    "| 0 0 0 | 0 0 0 | 0 0 0 |\n| 0 0 0 | 0 0 0 | 0 0 0 |\n| 0 0 0 | 0 0 0 | 0 0 0 |\n"
+    "--------+-------+--------\n";
+
+// Offsets of the rows and columns of the cells in the templates
+static const unsigned short GRID_ROWS[N] = { 0, 19, 38, 57, 76, 95, 114, 133, 152 };
+static const unsigned char GRID_COLS[N] = { 0, 2, 4, 6, 8, 10, 12, 14, 16 };
+static const unsigned short TABLE_ROWS[N] = { 26, 52, 78, 130, 156, 182, 234, 260, 286 };
+static const unsigned char TABLE_COLS[N] = { 2, 4, 6, 10, 12, 14, 18, 20, 22 };
+
+
+/**
+ * Function: format_sudoku
+ * -----------------------
+ * Render a grid into a buffer (see the output formats above).
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - format: The format to render.
+ * - buffer: Buffer of at least FORMAT_MAX_SIZE bytes (or the size of the format) receiving the grid,
+ *   not NUL-terminated.
+ * 
+ * Returns:
+ * - The number of bytes written.
+ */
+size_t format_sudoku(const Sudoku *sudoku, OutputFormat format, char *buffer) {
+    const int *cells = &sudoku->table[0][0];
+    switch(format) {
+        case FORMAT_GRID:
+            memcpy(buffer, GRID_TEMPLATE, GRID_TEXT_SIZE);
+            for(int i = 0; i < N; i++) {
+                for(int j = 0; j < N; j++) {
+                    buffer[GRID_ROWS[i] + GRID_COLS[j]] = '0' + cells[i*N + j];
+                }
+            }
+            return GRID_TEXT_SIZE;
+        case FORMAT_TABLE:
+            memcpy(buffer, TABLE_TEMPLATE, TABLE_TEXT_SIZE);
+            for(int i = 0; i < N; i++) {
+                for(int j = 0; j < N; j++) {
+                    buffer[TABLE_ROWS[i] + TABLE_COLS[j]] = '0' + cells[i*N + j];
+                }
+            }
+            return TABLE_TEXT_SIZE;
+        case FORMAT_LINE:
+            for(int i = 0; i < N*N; i++) {
+                buffer[i] = '0' + cells[i];
+            }
+            buffer[N*N] = '\n';
+            return LINE_TEXT_SIZE;
+        case FORMAT_PACKED:
+            pack_puzzle(sudoku, (unsigned char *)buffer);
+            return PACKED_RECORD_SIZE;
+    }
+    return 0;
+}
+
+
+/**
+ * Function: output_init
+ * ---------------------
+ * Set up a buffered output, collecting rendered grids in memory and writing them in large blocks.
+ * 
+ * Parameters:
+ * - output: Pointer to the OutputBuffer structure.
+ * - file: Stream receiving the grids.
+ * - format: The format of the grids.
+ * - storage: Memory used as buffer, at least FORMAT_MAX_SIZE bytes.
+ * - capacity: Size of the storage.
+ */
+void output_init(
+    OutputBuffer *output,
+    FILE *file,
+    OutputFormat format,
+    char *storage,
+    size_t capacity
+) {
+    output->file = file;
+    output->format = format;
+    output->data = storage;
+    output->capacity = capacity;
+    output->length = 0;
+    output->failed = false;
+}
+
+
+/**
+ * Function: output_flush
+ * ----------------------
+ * Write the buffered grids with a single call.
+ * 
+ * Parameters:
+ * - output: Pointer to the OutputBuffer structure.
+ * 
+ * Returns:
+ * - true if every write so far succeeded, false otherwise.
+ */
+bool output_flush(OutputBuffer *output) {
+    if(output->length > 0 && fwrite(output->data, 1, output->length, output->file) != output->length) {
+        output->failed = true;
+    }
+    output->length = 0;
+    return !output->failed;
+}
+
+
+/**
+ * Function: output_put
+ * --------------------
+ * Render a grid at the end of the buffer, writing the buffer out first if the grid does not fit.
+ * 
+ * Parameters:
+ * - output: Pointer to the OutputBuffer structure.
+ * - sudoku: Pointer to the Sudoku structure.
+ * 
+ * Returns:
+ * - true if every write so far succeeded, false otherwise.
+ */
+bool output_put(OutputBuffer *output, const Sudoku *sudoku) {
+    if(output->capacity - output->length < FORMAT_MAX_SIZE) {
+        output_flush(output);
+    }
+    output->length += format_sudoku(sudoku, output->format, output->data + output->length);
+    return !output->failed;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- MAPPED CORPUS --- //
+
+
+/**
+ * Function: map_file
+ * ------------------
+ * Map a whole file in memory, read-only, so that its puzzles can be parsed in place.
+ * 
+ * Parameters:
+ * - file: Pointer to the MappedFile structure receiving the mapping.
+ * - path: Path of the file.
+ * 
+ * Returns:
+ * - true if the file was mapped (an empty file gives an empty mapping),
+ *   false otherwise.
+ */
+bool map_file(MappedFile *file, const char *path) {
+    file->data = NULL;
+    file->size = 0;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return false;
+    }
+    if(size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(mapping != NULL) {
+            file->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        if(file->data == NULL) {
+            CloseHandle(handle);
+            return false;
         }
-        fprintf(file, "\n");
+        file->size = (size_t)size.QuadPart;
     }
-    fclose(file);
-}
\ No newline at end of file
+    CloseHandle(handle);
+#else
+    int handle = open(path, O_RDONLY);
+    if(handle < 0) {
+        return false;
+    }
+    struct stat info;
+    if(fstat(handle, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(handle);
+        return false;
+    }
+    if(info.st_size > 0) {
+        void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+        if(data == MAP_FAILED) {
+            close(handle);
+            return false;
+        }
+        // The file is read once, front to back
+        madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+        file->data = data;
+        file->size = (size_t)info.st_size;
+    }
+    close(handle);
+#endif
+    return true;
+}
+
+
+/**
+ * Function: unmap_file
+ * --------------------
+ * Release a mapping created by `map_file`.
+ * 
+ * Parameters:
+ * - file: Pointer to the MappedFile structure.
+ */
+void unmap_file(MappedFile *file) {
+    if(file->data != NULL) {
+#ifdef _WIN32
+        UnmapViewOfFile(file->data);
+#else
+        munmap((void *)file->data, file->size);
+#endif
+    }
+    file->data = NULL;
+    file->size = 0;
+}
+
+
+/**
+ * Function: mapped_lines
+ * ----------------------
+ * Get the range covering all the lines of a mapped file.
+ * 
+ * Parameters:
+ * - file: Pointer to the MappedFile structure.
+ * 
+ * Returns:
+ * - The range of lines, starting at line 1.
+ */
+LineRange mapped_lines(const MappedFile *file) {
+    LineRange range = { file->data, file->data + file->size, 1 };
+    return range;
+}
+
+
+/**
+ * Function: split_lines
+ * ---------------------
+ * Detach the next lines of a range into a range of their own, always cutting on a line boundary.
+ * The detached ranges can be parsed by different threads at the same time.
+ * 
+ * Parameters:
+ * - range: Pointer to the range being split, advanced past the detached lines.
+ * - n_lines: Maximum number of lines to detach.
+ * - part: Pointer to the range receiving the detached lines.
+ * 
+ * Returns:
+ * - true if at least one line was detached,
+ *   false if the range was empty.
+ */
+bool split_lines(LineRange *range, int n_lines, LineRange *part) {
+    if(range->begin >= range->end) {
+        return false;
+    }
+    part->begin = range->begin;
+    part->line = range->line;
+
+    const char *cursor = range->begin;
+    for(int i = 0; i < n_lines && cursor < range->end; i++) {
+        const char *newline = memchr(cursor, '\n', range->end - cursor);
+        cursor = (newline != NULL) ? newline + 1 : range->end;
+        range->line++;
+    }
+    part->end = cursor;
+    range->begin = cursor;
+    return true;
+}
+
+
+/**
+ * Function: next_record
+ * ---------------------
+ * Parse the next puzzle of a range in place, skipping blank lines and lines starting with '#'.
+ * Malformed records are returned as RECORD_INVALID along with their line number, for the caller to report,
+ * and the parsing goes on with the next line.
+ * 
+ * Parameters:
+ * - range: Pointer to the range, advanced past the record.
+ * - sudoku: Pointer to the Sudoku structure receiving the puzzle.
+ * - line: Pointer receiving the line number of the record.
+ * 
+ * Returns:
+ * - RECORD_PUZZLE if a puzzle was parsed,
+ *   RECORD_INVALID if the record is malformed,
+ *   RECORD_END at the end of the range.
+ */
+RecordStatus next_record(LineRange *range, Sudoku *sudoku, long *line) {
+    while(range->begin < range->end) {
+        const char *record = range->begin;
+        const char *newline = memchr(record, '\n', range->end - record);
+        const char *record_end = (newline != NULL) ? newline : range->end;
+        range->begin = (newline != NULL) ? newline + 1 : range->end;
+        *line = range->line++;
+
+        if(record == record_end || *record == '\r' || *record == '#') {
+            continue;
+        }
+        return parse_record(sudoku, record, record_end - record) ? RECORD_PUZZLE : RECORD_INVALID;
+    }
+    return RECORD_END;
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- PACKED FORMAT --- //
+
+
+/******************************************************************************
+ * Packed puzzle files
+ * Puzzles are stored as fixed-size binary records after a small header:
+ *
+ *     "SDKB" | version (uint32) | record size (uint32) | record | record | ...
+ *
+ * where every record holds the 81 cells row by row, one 4-bit digit each
+ * (0 for empty cells), two cells per byte with the first one in the high
+ * nibble: 41 bytes per puzzle instead of 82 for a text line.
+ * The number of puzzles follows from the file size, so records can be
+ * appended without rewriting the header.
+ ******************************************************************************/
+
+
+/**
+ * Function: pack_puzzle
+ * ---------------------
+ * Pack a puzzle into a record of PACKED_RECORD_SIZE bytes.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - record: Buffer receiving the record.
+ */
+void pack_puzzle(const Sudoku *sudoku, unsigned char *record) {
+    const int *cells = &sudoku->table[0][0];
+    for(int k = 0; k < N*N / 2; k++) {
+        record[k] = (unsigned char)(cells[2*k] << 4 | cells[2*k + 1]);
+    }
+    record[N*N / 2] = (unsigned char)(cells[N*N - 1] << 4);
+}
+
+
+/**
+ * Function: unpack_puzzle
+ * -----------------------
+ * Unpack a record of PACKED_RECORD_SIZE bytes into a puzzle.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure receiving the puzzle.
+ * - record: The record.
+ * 
+ * Returns:
+ * - true if every cell holds a digit from 0 to 9,
+ *   false otherwise.
+ */
+bool unpack_puzzle(Sudoku *sudoku, const unsigned char *record) {
+    int *cells = &sudoku->table[0][0];
+    unsigned char invalid = 0;
+    for(int k = 0; k < N*N / 2; k++) {
+        cells[2*k] = record[k] >> 4;
+        cells[2*k + 1] = record[k] & 0xF;
+        invalid |= (cells[2*k] > 9) | (cells[2*k + 1] > 9);
+    }
+    cells[N*N - 1] = record[N*N / 2] >> 4;
+    invalid |= (cells[N*N - 1] > 9) | (record[N*N / 2] & 0xF);
+    return !invalid;
+}
+
+
+/**
+ * Function: write_packed_header
+ * -----------------------------
+ * Write the header of a packed puzzle file.
+ * 
+ * Parameters:
+ * - file: Stream opened in binary mode.
+ * 
+ * Returns:
+ * - true on success, false otherwise.
+ */
+bool write_packed_header(FILE *file) {
+    uint32_t version = PACKED_VERSION, record_size = PACKED_RECORD_SIZE;
+    return fwrite(PACKED_MAGIC, 1, 4, file) == 4
+        && fwrite(&version, sizeof(version), 1, file) == 1
+        && fwrite(&record_size, sizeof(record_size), 1, file) == 1;
+}
+
+
+/**
+ * Function: read_packed_header
+ * ----------------------------
+ * Read and check the header of a packed puzzle file.
+ * 
+ * Parameters:
+ * - file: Stream opened in binary mode.
+ * 
+ * Returns:
+ * - true if the stream starts with the header of a supported version, false otherwise.
+ */
+bool read_packed_header(FILE *file) {
+    char magic[4];
+    uint32_t version, record_size;
+    return fread(magic, 1, 4, file) == 4 && memcmp(magic, PACKED_MAGIC, 4) == 0
+        && fread(&version, sizeof(version), 1, file) == 1 && version == PACKED_VERSION
+        && fread(&record_size, sizeof(record_size), 1, file) == 1 && record_size == PACKED_RECORD_SIZE;
+}
+
+
+/**
+ * Function: write_packed
+ * ----------------------
+ * Append a puzzle to a packed puzzle file.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - file: Stream positioned after the header or the previous record.
+ * 
+ * Returns:
+ * - true on success, false otherwise.
+ */
+bool write_packed(const Sudoku *sudoku, FILE *file) {
+    unsigned char record[PACKED_RECORD_SIZE];
+    pack_puzzle(sudoku, record);
+    return fwrite(record, PACKED_RECORD_SIZE, 1, file) == 1;
+}
+
+
+/**
+ * Function: read_packed
+ * ---------------------
+ * Read the next puzzle of a packed puzzle file.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure receiving the puzzle.
+ * - file: Stream positioned after the header or the previous record.
+ * 
+ * Returns:
+ * - RECORD_PUZZLE if a puzzle was read,
+ *   RECORD_INVALID if the record holds a nibble above 9,
+ *   RECORD_END at the end of the file (a truncated last record is ignored).
+ */
+RecordStatus read_packed(Sudoku *sudoku, FILE *file) {
+    unsigned char record[PACKED_RECORD_SIZE];
+    if(fread(record, PACKED_RECORD_SIZE, 1, file) != 1) {
+        return RECORD_END;
+    }
+    return unpack_puzzle(sudoku, record) ? RECORD_PUZZLE : RECORD_INVALID;
+}
+
+
+/**
+ * Function: packed_records
+ * ------------------------
+ * Get the range covering the records of a mapped packed file, if it is one.
+ * The range is cut into records instead of lines: see `split_records` and `next_packed`.
+ * 
+ * Parameters:
+ * - file: Pointer to the MappedFile structure.
+ * - range: Pointer to the range receiving the records, numbered from 1.
+ * 
+ * Returns:
+ * - true if the file starts with the header of a supported version, false otherwise.
+ */
+bool packed_records(const MappedFile *file, LineRange *range) {
+    uint32_t version, record_size;
+    if(file->size < PACKED_HEADER_SIZE || memcmp(file->data, PACKED_MAGIC, 4) != 0) {
+        return false;
+    }
+    memcpy(&version, file->data + 4, sizeof(version));
+    memcpy(&record_size, file->data + 8, sizeof(record_size));
+    if(version != PACKED_VERSION || record_size != PACKED_RECORD_SIZE) {
+        return false;
+    }
+
+    size_t n_records = (file->size - PACKED_HEADER_SIZE) / PACKED_RECORD_SIZE;
+    range->begin = file->data + PACKED_HEADER_SIZE;
+    range->end = range->begin + n_records * PACKED_RECORD_SIZE;
+    range->line = 1;
+    return true;
+}
+
+
+/**
+ * Function: split_records
+ * -----------------------
+ * Detach the next records of a packed range into a range of their own (see `split_lines`).
+ * 
+ * Parameters:
+ * - range: Pointer to the range being split, advanced past the detached records.
+ * - n_records: Maximum number of records to detach.
+ * - part: Pointer to the range receiving the detached records.
+ * 
+ * Returns:
+ * - true if at least one record was detached,
+ *   false if the range was empty.
+ */
+bool split_records(LineRange *range, int n_records, LineRange *part) {
+    if(range->begin >= range->end) {
+        return false;
+    }
+    size_t available = (range->end - range->begin) / PACKED_RECORD_SIZE;
+    size_t count = ((size_t)n_records < available) ? (size_t)n_records : available;
+    part->begin = range->begin;
+    part->end = range->begin + count * PACKED_RECORD_SIZE;
+    part->line = range->line;
+    range->begin = part->end;
+    range->line += count;
+    return true;
+}
+
+
+/**
+ * Function: next_packed
+ * ---------------------
+ * Unpack the next puzzle of a packed range in place (see `next_record`).
+ * 
+ * Parameters:
+ * - range: Pointer to the range, advanced past the record.
+ * - sudoku: Pointer to the Sudoku structure receiving the puzzle.
+ * - index: Pointer receiving the number of the record.
+ * 
+ * Returns:
+ * - RECORD_PUZZLE if a puzzle was unpacked,
+ *   RECORD_INVALID if the record holds a nibble above 9,
+ *   RECORD_END at the end of the range.
+ */
+RecordStatus next_packed(LineRange *range, Sudoku *sudoku, long *index) {
+    if(range->end - range->begin < PACKED_RECORD_SIZE) {
+        return RECORD_END;
+    }
+    const unsigned char *record = (const unsigned char *)range->begin;
+    range->begin += PACKED_RECORD_SIZE;
+    *index = range->line++;
+    return unpack_puzzle(sudoku, record) ? RECORD_PUZZLE : RECORD_INVALID;
+}
+
+
+/**
+ * Function: convert_to_packed
+ * ---------------------------
+ * Convert a stream of puzzles in the one-line format into a packed puzzle file.
+ * Blank lines and lines starting with '#' are skipped, malformed lines are skipped and counted.
+ * 
+ * Parameters:
+ * - text: Stream of puzzles, one per line.
+ * - packed: Stream receiving the packed file, opened in binary mode.
+ * - skipped: Pointer receiving the number of malformed lines.
+ * 
+ * Returns:
+ * - The number of puzzles written, or -1 on a write error.
+ */
+long convert_to_packed(FILE *text, FILE *packed, long *skipped) {
+    char line[128];
+    long count = 0;
+    *skipped = 0;
+    if(!write_packed_header(packed)) {
+        return -1;
+    }
+    char storage[OUTPUT_BUFFER_SIZE];
+    OutputBuffer output;
+    output_init(&output, packed, FORMAT_PACKED, storage, sizeof(storage));
+    while(fgets(line, sizeof(line), text) != NULL) {
+        if(strchr(line, '\n') == NULL) {
+            int ch;
+            while((ch = getc(text)) != EOF && ch != '\n');
+        }
+        if(line[0] == '\n' || line[0] == '\r' || line[0] == '#') {
+            continue;
+        }
+
+        Sudoku sudoku;
+        if(!parse_line(&sudoku, line)) {
+            (*skipped)++;
+            continue;
+        }
+        if(!output_put(&output, &sudoku)) {
+            return -1;
+        }
+        count++;
+    }
+    return output_flush(&output) ? count : -1;
+}
+
+
+/**
+ * Function: convert_to_text
+ * -------------------------
+ * Convert a packed puzzle file into puzzles in the one-line format.
+ * Malformed records are skipped and counted.
+ * 
+ * Parameters:
+ * - packed: Stream of the packed file, opened in binary mode.
+ * - text: Stream receiving the puzzles, one per line.
+ * - skipped: Pointer receiving the number of malformed records.
+ * 
+ * Returns:
+ * - The number of puzzles written, or -1 if the header is not valid or on a write error.
+ */
+long convert_to_text(FILE *packed, FILE *text, long *skipped) {
+    long count = 0;
+    *skipped = 0;
+    if(!read_packed_header(packed)) {
+        return -1;
+    }
+
+    char storage[OUTPUT_BUFFER_SIZE];
+    OutputBuffer output;
+    output_init(&output, text, FORMAT_LINE, storage, sizeof(storage));
+
+    Sudoku sudoku;
+    RecordStatus status;
+    while((status = read_packed(&sudoku, packed)) != RECORD_END) {
+        if(status == RECORD_INVALID) {
+            (*skipped)++;
+            continue;
+        }
+        if(!output_put(&output, &sudoku)) {
+            return -1;
+        }
+        count++;
+    }
+    return output_flush(&output) ? count : -1;
+}
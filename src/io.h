@@ -1,14 +1,129 @@
 #ifndef IO_H
 #define IO_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
 #define N 9
 
+#define GRID_TEXT_SIZE (N * (2*N + 1))
+#define TABLE_TEXT_SIZE (13 * 26)
+#define LINE_TEXT_SIZE (N*N + 1)
+#define FORMAT_MAX_SIZE TABLE_TEXT_SIZE
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+#define PACKED_MAGIC "SDKB"
+#define PACKED_VERSION 1
+#define PACKED_HEADER_SIZE 12
+#define PACKED_RECORD_SIZE 41
+
 typedef struct {
     int table[N][N];
 } Sudoku;
 
-void parse_file();
-void print_table();
-void write_to_file();
+/**
+ * Type: MappedFile
+ * ----------------
+ * A file mapped read-only in memory.
+ */
+typedef struct {
+    const char *data;
+    size_t size;
+} MappedFile;
+
+/**
+ * Type: LineRange
+ * ---------------
+ * A run of whole lines of a mapped file, and the number of its first line
+ * (or a run of records of a packed file, and the number of its first record).
+ */
+typedef struct {
+    const char *begin;
+    const char *end;
+    long line;
+} LineRange;
+
+typedef enum {
+    FORMAT_GRID,
+    FORMAT_TABLE,
+    FORMAT_LINE,
+    FORMAT_PACKED
+} OutputFormat;
+
+/**
+ * Type: OutputBuffer
+ * ------------------
+ * Grids rendered in one format and waiting to be written to a stream in a single call.
+ */
+typedef struct {
+    FILE *file;
+    OutputFormat format;
+    char *data;
+    size_t capacity;
+    size_t length;
+    bool failed;
+} OutputBuffer;
+
+typedef enum {
+    PARSE_OK,
+    PARSE_CANNOT_OPEN,
+    PARSE_INVALID_CHARACTER,
+    PARSE_TOO_FEW_CELLS,
+    PARSE_TOO_MANY_CELLS
+} ParseError;
+
+/**
+ * Type: ParseResult
+ * -----------------
+ * Outcome of parsing a puzzle: the error, where it was found (offset, line and column)
+ * and how many cells were read until then.
+ */
+typedef struct {
+    ParseError error;
+    size_t offset;
+    int line;
+    int column;
+    int cells;
+} ParseResult;
+
+typedef enum {
+    RECORD_PUZZLE,
+    RECORD_INVALID,
+    RECORD_END
+} RecordStatus;
+
+ParseResult parse_buffer(Sudoku *sudoku, const char *buffer, size_t length);
+const char *parse_error_message(ParseError error);
+void report_parse_error(const char *filename, ParseResult result);
+ParseResult parse_file(Sudoku *sudoku, const char *filename);
+bool parse_record(Sudoku *sudoku, const char *record, size_t length);
+bool parse_line(Sudoku *sudoku, const char *line);
+void print_table(Sudoku *sudoku);
+void write_to_file(Sudoku *sudoku, const char *filename);
+void write_line(Sudoku *sudoku, FILE *file);
+
+size_t format_sudoku(const Sudoku *sudoku, OutputFormat format, char *buffer);
+void output_init(OutputBuffer *output, FILE *file, OutputFormat format, char *storage, size_t capacity);
+bool output_flush(OutputBuffer *output);
+bool output_put(OutputBuffer *output, const Sudoku *sudoku);
+
+bool map_file(MappedFile *file, const char *path);
+void unmap_file(MappedFile *file);
+LineRange mapped_lines(const MappedFile *file);
+bool split_lines(LineRange *range, int n_lines, LineRange *part);
+RecordStatus next_record(LineRange *range, Sudoku *sudoku, long *line);
+
+void pack_puzzle(const Sudoku *sudoku, unsigned char *record);
+bool unpack_puzzle(Sudoku *sudoku, const unsigned char *record);
+bool write_packed_header(FILE *file);
+bool read_packed_header(FILE *file);
+bool write_packed(const Sudoku *sudoku, FILE *file);
+RecordStatus read_packed(Sudoku *sudoku, FILE *file);
+bool packed_records(const MappedFile *file, LineRange *range);
+bool split_records(LineRange *range, int n_records, LineRange *part);
+RecordStatus next_packed(LineRange *range, Sudoku *sudoku, long *index);
+long convert_to_packed(FILE *text, FILE *packed, long *skipped);
+long convert_to_text(FILE *packed, FILE *text, long *skipped);
 
 #endif
\ No newline at end of file
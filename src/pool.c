@@ -0,0 +1,246 @@
+#include "pool.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <unistd.h>
+#endif
+
+#define POOL_MAGIC "SDKP"
+#define POOL_VERSION 1
+
+
+/******************************************************************************
+ * Puzzle Pool
+ * The pool file is binary, so that loading it is a handful of reads:
+ *
+ *     "SDKP" | version (uint32) | count of levels 1–4 (4 x uint32)
+ *     | puzzles of level 1 | ... | puzzles of level 4
+ *
+ * where every puzzle is its 81 cells, one byte each, row by row.
+ * Several processes share the file (one serving, one refilling), so every
+ * read-modify-write of the pool happens while holding its lock file.
+ ******************************************************************************/
+
+
+/**
+ * Function: puzzle_pool_load
+ * --------------------------
+ * Loads a pool from its binary file. A missing file gives an empty pool.
+ *
+ * Parameters:
+ * - pool: Pointer to the PuzzlePool structure to fill.
+ * - path: Path to the pool file.
+ *
+ * Returns:
+ * - true on success, false if the file exists but is not a valid pool file (bad header, counts above
+ *   the capacity, truncated data or cells outside 0-9).
+ */
+bool puzzle_pool_load(PuzzlePool *pool, const char *path) {
+    memset(pool->counts, 0, sizeof(pool->counts));
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) {
+        return true;
+    }
+
+    char magic[4];
+    uint32_t version, counts[POOL_LEVELS];
+    bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, POOL_MAGIC, 4) == 0
+        && fread(&version, sizeof(version), 1, file) == 1 && version == POOL_VERSION
+        && fread(counts, sizeof(uint32_t), POOL_LEVELS, file) == POOL_LEVELS;
+
+    unsigned char cells[POOL_CAPACITY][N * N];
+    for(int level = 1; level <= POOL_LEVELS && ok; level++) {
+        // The count is checked as read, before it sizes the read into `cells`
+        size_t count = counts[level - 1];
+        ok = count <= POOL_CAPACITY && fread(cells, N * N, count, file) == count;
+        for(size_t k = 0; k < count && ok; k++) {
+            for(int i = 0; i < N * N && ok; i++) {
+                ok = cells[k][i] <= N;
+                pool->puzzles[level][k].table[i / N][i % N] = cells[k][i];
+            }
+        }
+        pool->counts[level] = ok ? (int)count : 0;
+    }
+    fclose(file);
+    if(!ok) {
+        memset(pool->counts, 0, sizeof(pool->counts));
+    }
+    return ok;
+}
+
+
+/**
+ * Function: puzzle_pool_save
+ * --------------------------
+ * Saves a pool to its binary file. The pool is written to a temporary file first and then renamed,
+ * so a crash never leaves a truncated pool behind.
+ *
+ * Parameters:
+ * - pool: Pointer to the PuzzlePool structure.
+ * - path: Path to the pool file.
+ *
+ * Returns:
+ * - true on success, false otherwise.
+ */
+bool puzzle_pool_save(const PuzzlePool *pool, const char *path) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *file = fopen(tmp_path, "wb");
+    if(file == NULL) {
+        return false;
+    }
+
+    uint32_t version = POOL_VERSION, counts[POOL_LEVELS];
+    for(int level = 1; level <= POOL_LEVELS; level++) {
+        counts[level - 1] = pool->counts[level];
+    }
+    bool ok = fwrite(POOL_MAGIC, 1, 4, file) == 4
+        && fwrite(&version, sizeof(version), 1, file) == 1
+        && fwrite(counts, sizeof(uint32_t), POOL_LEVELS, file) == POOL_LEVELS;
+
+    unsigned char cells[POOL_CAPACITY][N * N];
+    for(int level = 1; level <= POOL_LEVELS && ok; level++) {
+        int count = pool->counts[level];
+        for(int k = 0; k < count; k++) {
+            for(int i = 0; i < N * N; i++) {
+                cells[k][i] = pool->puzzles[level][k].table[i / N][i % N];
+            }
+        }
+        ok = fwrite(cells, N * N, count, file) == (size_t)count;
+    }
+    ok = (fclose(file) == 0) && ok;
+
+#ifdef _WIN32
+    // Windows does not rename over an existing file
+    if(ok) remove(path);
+#endif
+    if(!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Function: puzzle_pool_take
+ * --------------------------
+ * Serves a ready puzzle of a level in O(1).
+ *
+ * Returns:
+ * - true if a puzzle was copied to `sudoku`, false if the pool of the level is empty.
+ */
+bool puzzle_pool_take(PuzzlePool *pool, int level, Sudoku *sudoku) {
+    if(level < 1 || level > POOL_LEVELS || pool->counts[level] == 0) {
+        return false;
+    }
+    *sudoku = pool->puzzles[level][--pool->counts[level]];
+    return true;
+}
+
+
+/**
+ * Function: puzzle_pool_put
+ * -------------------------
+ * Adds a puzzle to the pool of a level.
+ *
+ * Returns:
+ * - true if the puzzle was added, false if the pool of the level is full.
+ */
+bool puzzle_pool_put(PuzzlePool *pool, int level, const Sudoku *sudoku) {
+    if(level < 1 || level > POOL_LEVELS || pool->counts[level] == POOL_CAPACITY) {
+        return false;
+    }
+    pool->puzzles[level][pool->counts[level]++] = *sudoku;
+    return true;
+}
+
+
+/**
+ * Function: puzzle_pool_needs_refill
+ * ----------------------------------
+ * Whether the pool of a level went below its low-water mark.
+ */
+bool puzzle_pool_needs_refill(const PuzzlePool *pool, int level) {
+    return pool->counts[level] < POOL_LOW_WATER;
+}
+
+
+/**
+ * Function: puzzle_pool_is_full
+ * -----------------------------
+ * Whether the pool of a level reached its capacity.
+ */
+bool puzzle_pool_is_full(const PuzzlePool *pool, int level) {
+    return pool->counts[level] >= POOL_CAPACITY;
+}
+
+
+/**
+ * Function: puzzle_pool_lock
+ * --------------------------
+ * Takes an exclusive lock on the file `<path><suffix>`, created if missing.
+ * The lock is released by `puzzle_pool_unlock` or when the process exits.
+ *
+ * Parameters:
+ * - path: Path to the pool file.
+ * - suffix: Suffix of the lock file, so that a pool can have several independent locks.
+ * - wait: Whether to wait for the lock or to give up if another process holds it.
+ *
+ * Returns:
+ * - A handle to pass to `puzzle_pool_unlock`, or -1 if the lock was not taken.
+ */
+int puzzle_pool_lock(const char *path, const char *suffix, bool wait) {
+    char lock_path[512];
+    snprintf(lock_path, sizeof(lock_path), "%s%s", path, suffix);
+
+#ifdef _WIN32
+    int handle = _open(lock_path, _O_RDWR | _O_CREAT, 0644);
+    if(handle < 0) {
+        return -1;
+    }
+    OVERLAPPED overlapped = {0};
+    DWORD flags = LOCKFILE_EXCLUSIVE_LOCK | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+    if(!LockFileEx((HANDLE)_get_osfhandle(handle), flags, 0, 1, 0, &overlapped)) {
+        _close(handle);
+        return -1;
+    }
+#else
+    int handle = open(lock_path, O_RDWR | O_CREAT, 0644);
+    if(handle < 0) {
+        return -1;
+    }
+    if(flock(handle, LOCK_EX | (wait ? 0 : LOCK_NB)) != 0) {
+        close(handle);
+        return -1;
+    }
+#endif
+    return handle;
+}
+
+
+/**
+ * Function: puzzle_pool_unlock
+ * ----------------------------
+ * Releases a lock taken with `puzzle_pool_lock` (-1 is ignored).
+ */
+void puzzle_pool_unlock(int handle) {
+    if(handle < 0) return;
+
+#ifdef _WIN32
+    OVERLAPPED overlapped = {0};
+    UnlockFileEx((HANDLE)_get_osfhandle(handle), 0, 1, 0, &overlapped);
+    _close(handle);
+#else
+    flock(handle, LOCK_UN);
+    close(handle);
+#endif
+}
@@ -0,0 +1,41 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "io.h"
+#include <stdbool.h>
+
+#define POOL_LEVELS 4
+#define POOL_CAPACITY 64
+#define POOL_LOW_WATER 16
+
+/**
+ * Struct: PuzzlePool
+ * ------------------
+ * Puzzles generated ahead of time, one stack per level, served in O(1).
+ *
+ * Fields:
+ * - puzzles: Ready puzzles of each level (index 0 is unused).
+ * - counts: Number of ready puzzles of each level.
+ */
+typedef struct {
+    Sudoku puzzles[POOL_LEVELS + 1][POOL_CAPACITY];
+    int counts[POOL_LEVELS + 1];
+} PuzzlePool;
+
+bool puzzle_pool_load(PuzzlePool *pool, const char *path);
+
+bool puzzle_pool_save(const PuzzlePool *pool, const char *path);
+
+bool puzzle_pool_take(PuzzlePool *pool, int level, Sudoku *sudoku);
+
+bool puzzle_pool_put(PuzzlePool *pool, int level, const Sudoku *sudoku);
+
+bool puzzle_pool_needs_refill(const PuzzlePool *pool, int level);
+
+bool puzzle_pool_is_full(const PuzzlePool *pool, int level);
+
+int puzzle_pool_lock(const char *path, const char *suffix, bool wait);
+
+void puzzle_pool_unlock(int handle);
+
+#endif
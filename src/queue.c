@@ -0,0 +1,216 @@
+#include "queue.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sched.h>
+    #include <time.h>
+#endif
+
+#define CACHE_LINE 64
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- BOUNDED QUEUE --- //
+
+
+/******************************************************************************
+ * Bounded MPMC queue
+ * Lock-free queue of fixed-size items for any number of producers and
+ * consumers (D. Vyukov's bounded queue). Every slot carries a sequence number:
+ * a producer may fill slot `pos % capacity` when its sequence equals `pos`,
+ * a consumer may empty it when its sequence equals `pos + 1`. Positions are
+ * claimed with a compare-and-swap, so no thread ever waits on a lock, and a
+ * full queue makes the producers back off, which bounds the memory in flight.
+ ******************************************************************************/
+
+
+struct BoundedQueue {
+    size_t capacity;
+    size_t mask;
+    size_t item_size;
+    atomic_size_t *sequences;
+    unsigned char *items;
+
+    // Positions on separate cache lines, so producers and consumers do not contend
+    _Alignas(CACHE_LINE) atomic_size_t push_position;
+    _Alignas(CACHE_LINE) atomic_size_t pop_position;
+};
+
+
+/**
+ * Function: queue_create
+ * ----------------------
+ * Creates an empty queue.
+ *
+ * Parameters:
+ * - capacity: Number of slots, rounded up to a power of two.
+ * - item_size: Size in bytes of every item.
+ *
+ * Returns:
+ * - Pointer to the new queue, or NULL if it could not be allocated.
+ */
+BoundedQueue *queue_create(size_t capacity, size_t item_size) {
+    size_t size = 2;
+    while(size < capacity) size *= 2;
+
+    BoundedQueue *queue = calloc(1, sizeof(BoundedQueue));
+    if(queue == NULL) {
+        return NULL;
+    }
+    queue->capacity = size;
+    queue->mask = size - 1;
+    queue->item_size = item_size;
+    queue->sequences = malloc(size * sizeof(atomic_size_t));
+    queue->items = malloc(size * item_size);
+    if(queue->sequences == NULL || queue->items == NULL) {
+        queue_destroy(queue);
+        return NULL;
+    }
+    for(size_t i = 0; i < size; i++) {
+        atomic_init(&queue->sequences[i], i);
+    }
+    atomic_init(&queue->push_position, 0);
+    atomic_init(&queue->pop_position, 0);
+    return queue;
+}
+
+
+/**
+ * Function: queue_try_push
+ * ------------------------
+ * Copies an item into the queue, unless it is full.
+ *
+ * Parameters:
+ * - queue: Pointer to the BoundedQueue structure.
+ * - item: Pointer to the item.
+ *
+ * Returns:
+ * - true if the item was queued,
+ *   false if the queue is full.
+ */
+bool queue_try_push(BoundedQueue *queue, const void *item) {
+    size_t position = atomic_load_explicit(&queue->push_position, memory_order_relaxed);
+    while(true) {
+        atomic_size_t *sequence = &queue->sequences[position & queue->mask];
+        size_t current = atomic_load_explicit(sequence, memory_order_acquire);
+        ptrdiff_t difference = (ptrdiff_t)current - (ptrdiff_t)position;
+
+        if(difference == 0) {
+            // The slot is free: claim the position (on failure `position` is reloaded)
+            if(atomic_compare_exchange_weak_explicit(&queue->push_position, &position, position + 1,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+                memcpy(queue->items + (position & queue->mask) * queue->item_size, item, queue->item_size);
+                atomic_store_explicit(sequence, position + 1, memory_order_release);
+                return true;
+            }
+        } else if(difference < 0) {
+            return false;
+        } else {
+            position = atomic_load_explicit(&queue->push_position, memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+ * Function: queue_try_pop
+ * -----------------------
+ * Copies the oldest item out of the queue, unless it is empty.
+ *
+ * Parameters:
+ * - queue: Pointer to the BoundedQueue structure.
+ * - item: Pointer receiving the item.
+ *
+ * Returns:
+ * - true if an item was taken,
+ *   false if the queue is empty.
+ */
+bool queue_try_pop(BoundedQueue *queue, void *item) {
+    size_t position = atomic_load_explicit(&queue->pop_position, memory_order_relaxed);
+    while(true) {
+        atomic_size_t *sequence = &queue->sequences[position & queue->mask];
+        size_t current = atomic_load_explicit(sequence, memory_order_acquire);
+        ptrdiff_t difference = (ptrdiff_t)current - (ptrdiff_t)(position + 1);
+
+        if(difference == 0) {
+            if(atomic_compare_exchange_weak_explicit(&queue->pop_position, &position, position + 1,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+                memcpy(item, queue->items + (position & queue->mask) * queue->item_size, queue->item_size);
+                // Hand the slot back to the producers of the next lap
+                atomic_store_explicit(sequence, position + queue->capacity, memory_order_release);
+                return true;
+            }
+        } else if(difference < 0) {
+            return false;
+        } else {
+            position = atomic_load_explicit(&queue->pop_position, memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+ * Function: queue_backoff
+ * -----------------------
+ * Waits a little before retrying an operation on a full or empty queue: yields the processor at first,
+ * then sleeps for increasing times up to a millisecond, so idle threads do not burn a core.
+ *
+ * Parameters:
+ * - attempt: Pointer to the number of failed attempts so far (reset it to 0 after a success).
+ */
+void queue_backoff(int *attempt) {
+    (*attempt)++;
+    if(*attempt < 16) {
+#ifdef _WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+        return;
+    }
+    long microseconds = (*attempt < 26) ? 1L << (*attempt - 16) : 1000;
+#ifdef _WIN32
+    Sleep((DWORD)((microseconds + 999) / 1000));
+#else
+    struct timespec pause = { 0, microseconds * 1000 };
+    nanosleep(&pause, NULL);
+#endif
+}
+
+
+/**
+ * Function: queue_push
+ * --------------------
+ * Copies an item into the queue, waiting while it is full.
+ *
+ * Parameters:
+ * - queue: Pointer to the BoundedQueue structure.
+ * - item: Pointer to the item.
+ */
+void queue_push(BoundedQueue *queue, const void *item) {
+    int attempt = 0;
+    while(!queue_try_push(queue, item)) {
+        queue_backoff(&attempt);
+    }
+}
+
+
+/**
+ * Function: queue_destroy
+ * -----------------------
+ * Frees a queue and the items left in it.
+ *
+ * Parameters:
+ * - queue: Pointer to the BoundedQueue structure.
+ */
+void queue_destroy(BoundedQueue *queue) {
+    if(queue == NULL) return;
+    free(queue->sequences);
+    free(queue->items);
+    free(queue);
+}
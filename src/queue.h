@@ -0,0 +1,21 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct BoundedQueue BoundedQueue;
+
+BoundedQueue *queue_create(size_t capacity, size_t item_size);
+
+bool queue_try_push(BoundedQueue *queue, const void *item);
+
+bool queue_try_pop(BoundedQueue *queue, void *item);
+
+void queue_push(BoundedQueue *queue, const void *item);
+
+void queue_backoff(int *attempt);
+
+void queue_destroy(BoundedQueue *queue);
+
+#endif
@@ -0,0 +1,109 @@
+#include "rng.h"
+#include <stdint.h>
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- PSEUDO-RANDOM NUMBER GENERATOR --- //
+
+
+/**
+ * Function: rotl
+ * --------------
+ * Rotates a 64-bit word to the left.
+ */
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+
+/**
+ * Function: splitmix64
+ * --------------------
+ * Advances a SplitMix64 state and returns its next output.
+ * Used to expand a single seed into the four words of the xoshiro state.
+ *
+ * Parameters:
+ * - state: Pointer to the SplitMix64 state.
+ *
+ * Returns:
+ * - The next 64-bit output.
+ */
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * Function: rng_seed
+ * ------------------
+ * Initializes the generator from a seed. Equal seeds give equal sequences.
+ *
+ * Parameters:
+ * - rng: Pointer to the Rng structure.
+ * - seed: Seed value.
+ */
+void rng_seed(Rng *rng, uint64_t seed) {
+    uint64_t state = seed;
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&state);
+    }
+}
+
+
+/**
+ * Function: rng_next
+ * ------------------
+ * Draws the next 64-bit output of xoshiro256**.
+ *
+ * Parameters:
+ * - rng: Pointer to the Rng structure.
+ *
+ * Returns:
+ * - A uniformly distributed 64-bit value.
+ */
+uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+
+/**
+ * Function: rng_int
+ * -----------------
+ * Draws an integer uniformly from [0, bound) without the bias of a plain modulo,
+ * using Lemire's multiply-and-reject method.
+ *
+ * Parameters:
+ * - rng: Pointer to the Rng structure.
+ * - bound: Upper bound (exclusive), must be positive.
+ *
+ * Returns:
+ * - A random integer between 0 and bound - 1.
+ */
+int rng_int(Rng *rng, int bound) {
+    uint32_t range = (uint32_t)bound;
+    uint64_t product = (rng_next(rng) >> 32) * range;
+    uint32_t low = (uint32_t)product;
+
+    if (low < range) {
+        uint32_t threshold = -range % range;
+        while (low < threshold) {
+            product = (rng_next(rng) >> 32) * range;
+            low = (uint32_t)product;
+        }
+    }
+    return (int)(product >> 32);
+}
@@ -0,0 +1,23 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * Struct: Rng
+ * -----------
+ * State of a xoshiro256** pseudo-random generator.
+ * Each generation context owns one, so that threads never share random state
+ * and a run can be replayed exactly from its seed.
+ */
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+void rng_seed(Rng *rng, uint64_t seed);
+
+uint64_t rng_next(Rng *rng);
+
+int rng_int(Rng *rng, int bound);
+
+#endif
@@ -0,0 +1,106 @@
+#include "seed_bank.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #define PATH_SEPARATOR "\\"
+#else
+    #define PATH_SEPARATOR "/"
+#endif
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- SEED BANK --- //
+
+
+/**
+ * Function: seed_bank_load_level
+ * ------------------------------
+ * Loads the seed puzzles `puzzle1.txt`, `puzzle2.txt`, ... of one level folder, stopping at the first missing file.
+ * Malformed files are reported and skipped.
+ *
+ * Parameters:
+ * - bank: Pointer to the SeedBank structure.
+ * - level: Level of the seeds.
+ * - folder: Path to the folder of the level.
+ *
+ * Returns:
+ * - The number of seeds loaded.
+ */
+static int seed_bank_load_level(
+    SeedBank *bank,
+    int level,
+    const char *folder
+) {
+    char file_path[512];
+    int count = 0;
+
+    for (int index = 1; count < MAX_SEEDS_PER_LEVEL; index++) {
+        snprintf(file_path, sizeof(file_path), "%s" PATH_SEPARATOR "puzzle%d.txt", folder, index);
+        FILE *file = fopen(file_path, "r");
+        if (file == NULL) break;
+        fclose(file);
+
+        // A malformed seed is reported and left out
+        ParseResult result = parse_file(&bank->puzzles[level][count], file_path);
+        if (result.error != PARSE_OK) {
+            report_parse_error(file_path, result);
+            continue;
+        }
+        count++;
+    }
+    bank->counts[level] = count;
+    return count;
+}
+
+
+/**
+ * Function: seed_bank_load
+ * ------------------------
+ * Reads the whole seed bank into memory, so that generation never touches the disk again.
+ * The folder of each level is looked up as `Level<n>` and then `level<n>`, since the names differ in case
+ * and file systems such as the Linux ones are case sensitive.
+ *
+ * Parameters:
+ * - bank: Pointer to the SeedBank structure to fill.
+ * - seeds_path: Path to the folder containing the seed puzzles.
+ *
+ * Returns:
+ * - The total number of seeds loaded (0 if the folder is missing).
+ */
+int seed_bank_load(SeedBank *bank, const char *seeds_path) {
+    char folder[512];
+    int total = 0;
+
+    memset(bank->counts, 0, sizeof(bank->counts));
+    for (int level = 1; level <= MAX_SEED_LEVEL; level++) {
+        snprintf(folder, sizeof(folder), "%s" PATH_SEPARATOR "Level%d", seeds_path, level);
+        if (seed_bank_load_level(bank, level, folder) == 0) {
+            snprintf(folder, sizeof(folder), "%s" PATH_SEPARATOR "level%d", seeds_path, level);
+            seed_bank_load_level(bank, level, folder);
+        }
+        total += bank->counts[level];
+    }
+    return total;
+}
+
+
+/**
+ * Function: seed_bank_count
+ * -------------------------
+ * Returns the number of seed puzzles available for a level (0 for levels outside 1–MAX_SEED_LEVEL).
+ */
+int seed_bank_count(const SeedBank *bank, int level) {
+    if (bank == NULL || level < 1 || level > MAX_SEED_LEVEL) return 0;
+    return bank->counts[level];
+}
+
+
+/**
+ * Function: seed_bank_get
+ * -----------------------
+ * Returns the seed puzzle with the given index for a level.
+ */
+const Sudoku *seed_bank_get(const SeedBank *bank, int level, int index) {
+    return &bank->puzzles[level][index];
+}
@@ -0,0 +1,29 @@
+#ifndef SEED_BANK_H
+#define SEED_BANK_H
+
+#include "io.h"
+
+#define MAX_SEED_LEVEL 4
+#define MAX_SEEDS_PER_LEVEL 64
+
+/**
+ * Struct: SeedBank
+ * ----------------
+ * Seed puzzles of every level, loaded once at startup and indexed by level.
+ *
+ * Fields:
+ * - puzzles: Seed puzzles of each level (index 0 is unused).
+ * - counts: Number of seed puzzles loaded for each level.
+ */
+typedef struct {
+    Sudoku puzzles[MAX_SEED_LEVEL + 1][MAX_SEEDS_PER_LEVEL];
+    int counts[MAX_SEED_LEVEL + 1];
+} SeedBank;
+
+int seed_bank_load(SeedBank *bank, const char *seeds_path);
+
+int seed_bank_count(const SeedBank *bank, int level);
+
+const Sudoku *seed_bank_get(const SeedBank *bank, int level, int index);
+
+#endif
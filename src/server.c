@@ -0,0 +1,301 @@
+#include "server.h"
+#include "generator.h"
+#include "io.h"
+#include "rng.h"
+#include "sudoku.h"
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+#define MAX_REQUEST 256
+#define HINT_BUFFER 4096
+
+
+/******************************************************************************
+ * Server Protocol
+ * One request per line, one response per line. Puzzles are 81 characters,
+ * row by row, with '0' or '.' for the empty cells.
+ *
+ *     solve <puzzle>     ok <n> <solution 1> ... <solution n>   (n <= N_SOL)
+ *     count <puzzle>     ok <n>                   (n == N_SOL means N_SOL or more)
+ *     rate <puzzle>      ok <level> <naked single> <hidden single> <naked pair>
+ *                           <hidden pair> <pointing pair> <naked triple>
+ *                           <hidden triple> <pointing triple> <x-wing>
+ *     generate <level>   ok <puzzle>
+ *     hint <puzzle>      ok <next move of the human solver>
+ *     quit               (closes the connection)
+ *
+ * Failures are answered with "err <reason>". The server keeps the seed bank
+ * and the puzzle store across requests, so a request costs only the work it
+ * asks for. Requests on a puzzle are answered by the API of sudoku.c.
+ ******************************************************************************/
+
+
+/**
+ * Function: handle_request
+ * ------------------------
+ * Executes one request and writes its response line.
+
+ * Parameters:
+ * - command: Name of the request.
+ * - argument: Argument of the request (may be empty).
+ * - out: Stream receiving the response.
+ * - config: Resources of the server.
+ * - rng: Random generator of the connection.
+ */
+static void handle_request(
+    const char *command,
+    const char *argument,
+    FILE *out,
+    const ServerConfig *config,
+    Rng *rng
+) {
+    if(strcmp(command, "generate") == 0) {
+        Sudoku sudoku;
+        int level = atoi(argument);
+        if(level < 1 || level > 4) {
+            fputs("err level must be between 1 and 4\n", out);
+            return;
+        }
+        if((config->pool_file == NULL || !serve_from_pool(config->pool_file, level, &sudoku))
+            && !generate_new_puzzle(config->store, &sudoku, level, config->seeds, ".", false, NULL, 1, rng)) {
+            fprintf(out, "err %s\n", sudoku_strerror(SUDOKU_ERROR_GENERATION));
+            return;
+        }
+        fputs("ok ", out);
+        write_line(&sudoku, out);
+        return;
+    }
+
+    // The other requests take a puzzle and are answered by the library API
+    if(strlen(argument) != SUDOKU_CELLS) {
+        fprintf(out, "err %s\n", sudoku_strerror(SUDOKU_ERROR_FORMAT));
+        return;
+    }
+    int result;
+    if(strcmp(command, "solve") == 0) {
+        char solutions[SUDOKU_MAX_SOLUTIONS * SUDOKU_CELLS];
+        result = sudoku_solve(argument, solutions, SUDOKU_MAX_SOLUTIONS);
+        if(result >= 0) {
+            fprintf(out, "ok %d", result);
+            for(int k = 0; k < result; k++) {
+                fprintf(out, " %.*s", SUDOKU_CELLS, solutions + k * SUDOKU_CELLS);
+            }
+            fputc('\n', out);
+        }
+    } else if(strcmp(command, "count") == 0) {
+        result = sudoku_count_solutions(argument);
+        if(result >= 0) {
+            fprintf(out, "ok %d\n", result);
+        }
+    } else if(strcmp(command, "rate") == 0) {
+        int techniques[SUDOKU_TECHNIQUES];
+        result = sudoku_rate(argument, techniques);
+        if(result >= 0) {
+            fprintf(out, "ok %d", result);
+            for(int k = 0; k < SUDOKU_TECHNIQUES; k++) {
+                fprintf(out, " %d", techniques[k]);
+            }
+            fputc('\n', out);
+        }
+    } else if(strcmp(command, "hint") == 0) {
+        char hint[HINT_BUFFER];
+        result = sudoku_hint(argument, hint, sizeof(hint));
+        if(result >= 0) {
+
+            // One response per line: the lines of the move are separated by ';'
+            for(char *c = hint; *c; c++) {
+                if(*c == '\n') *c = ';';
+            }
+            if(result > 0 && hint[result - 1] == ';') hint[result - 1] = '\0';
+            fprintf(out, "ok %s\n", hint);
+        }
+    } else {
+        fputs("err unknown request\n", out);
+        return;
+    }
+    if(result < 0) {
+        fprintf(out, "err %s\n", sudoku_strerror(result));
+    }
+}
+
+
+/**
+ * Function: serve_stream
+ * ----------------------
+ * Answers the requests read from a stream until it ends, a `quit` request is received or a response
+ * cannot be written (the client has gone away).
+ * Every response is flushed right away, so the client can wait for it before sending the next request.
+
+ * Parameters:
+ * - in: Stream of requests.
+ * - out: Stream receiving the responses.
+ * - config: Resources of the server.
+ * - stream: Index of the random stream of the connection.
+ *
+ * Returns:
+ * - 0 when the input ends or on `quit`,
+ *   1 if a response could not be written.
+ */
+int serve_stream(
+    FILE *in,
+    FILE *out,
+    const ServerConfig *config,
+    uint64_t stream
+) {
+    Rng rng;
+    rng_seed(&rng, config->seed + 0x9E3779B97F4A7C15ULL * stream);
+
+    char line[MAX_REQUEST];
+    while(fgets(line, sizeof(line), in) != NULL) {
+
+        // Requests longer than the buffer are rejected as a whole
+        if(strchr(line, '\n') == NULL && !feof(in)) {
+            int ch;
+            while((ch = fgetc(in)) != EOF && ch != '\n');
+            fputs("err request too long\n", out);
+            if(fflush(out) != 0) return 1;
+            continue;
+        }
+
+        char *command = line;
+        while(isspace((unsigned char)*command)) command++;
+        if(*command == '\0') continue;
+        char *argument = command;
+        while(*argument && !isspace((unsigned char)*argument)) argument++;
+        if(*argument) *argument++ = '\0';
+        while(isspace((unsigned char)*argument)) argument++;
+        char *end = argument + strlen(argument);
+        while(end > argument && isspace((unsigned char)end[-1])) *--end = '\0';
+
+        if(strcmp(command, "quit") == 0) break;
+        handle_request(command, argument, out, config, &rng);
+        if(fflush(out) != 0) return 1;
+    }
+    return 0;
+}
+
+
+#ifndef _WIN32
+
+typedef struct {
+    int fd;
+    uint64_t stream;
+    const ServerConfig *config;
+} Connection;
+
+
+/**
+ * Function: connection_main
+ * -------------------------
+ * Body of the thread serving one client of the socket.
+ */
+static void *connection_main(void *arg) {
+    Connection *connection = arg;
+    FILE *in = fdopen(connection->fd, "r");
+    FILE *out = fdopen(dup(connection->fd), "w");
+    if(in != NULL && out != NULL) {
+        serve_stream(in, out, connection->config, connection->stream);
+    }
+    if(in != NULL) fclose(in); else close(connection->fd);
+    if(out != NULL) fclose(out);
+    free(connection);
+    return NULL;
+}
+
+#endif
+
+
+/**
+ * Function: serve_socket
+ * ----------------------
+ * Listens on a local Unix socket and serves every client on its own thread with `serve_stream`.
+ * Not available on Windows, where the server reads the requests on the standard input only.
+
+ * Parameters:
+ * - path: Path of the socket (replaced if it exists).
+ * - config: Resources of the server.
+ *
+ * Returns:
+ * - 1 if the socket could not be set up or stopped accepting connections. Otherwise the server runs until
+ *   it is killed.
+ */
+int serve_socket(
+    const char *path,
+    const ServerConfig *config
+) {
+#ifdef _WIN32
+    (void)config;
+    fprintf(stderr, "Unix sockets are not supported on this platform, use the standard input instead of '%s'\n", path);
+    return 1;
+#else
+    struct sockaddr_un address = {0};
+    address.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: '%s'\n", path);
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+
+    // A client closing its connection before the response must only end that connection, not the server:
+    // the writes then fail with EPIPE instead of raising SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if(listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        perror("Error opening the socket");
+        if(listener >= 0) close(listener);
+        return 1;
+    }
+
+    int failures = 0;
+    for(uint64_t stream = 0; ; stream++) {
+        int fd = accept(listener, NULL, NULL);
+        if(fd < 0) {
+            if(errno == EINTR || errno == ECONNABORTED) continue;
+            if(errno == EBADF || errno == EINVAL || errno == ENOTSOCK || errno == EOPNOTSUPP) {
+                perror("Error accepting a connection");
+                close(listener);
+                return 1;
+            }
+            // Out of descriptors or memory: wait for some to be released, from 1 ms up to 1 s, instead of spinning
+            if(failures == 0) perror("Error accepting a connection");
+            long milliseconds = (failures < 10) ? 1L << failures : 1000;
+            struct timespec pause = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+            nanosleep(&pause, NULL);
+            failures++;
+            continue;
+        }
+        failures = 0;
+
+        Connection *connection = malloc(sizeof(Connection));
+        pthread_t thread;
+        if(connection == NULL) {
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->stream = stream;
+        connection->config = config;
+        if(pthread_create(&thread, NULL, connection_main, connection) != 0) {
+            close(fd);
+            free(connection);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+#endif
+}
@@ -0,0 +1,31 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "seed_bank.h"
+#include "store.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Struct: ServerConfig
+ * --------------------
+ * Resources shared by all the connections of the server.
+ *
+ * Fields:
+ * - seeds: Seed bank used by `generate`.
+ * - store: Puzzle store consulted by `generate`, or NULL.
+ * - pool_file: Pool file `generate` serves from when it is not empty, or NULL.
+ * - seed: Base seed of the random generators (connection k uses its own stream derived from it).
+ */
+typedef struct {
+    const SeedBank *seeds;
+    PuzzleStore *store;
+    const char *pool_file;
+    uint64_t seed;
+} ServerConfig;
+
+int serve_stream(FILE *in, FILE *out, const ServerConfig *config, uint64_t stream);
+
+int serve_socket(const char *path, const ServerConfig *config);
+
+#endif
@@ -1,6 +1,10 @@
+#include "batch.h"
 #include "helpers.h"
 #include "io.h"
+#include "solver_backtrack.h"
 #include "solver_human.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -19,47 +23,42 @@
 
 
 /**
- * Function: solve_sudoku
- * ----------------------
- * Solve the Sudoku puzzle using the backtracking algorithm.
+ * Function: solve_recursive
+ * -------------------------
+ * Backtracking search of `solve_sudoku`, one call per guess.
  * 
  * Parameters:
- * - sudoku: Pointer to the Sudoku structure.
- * - n_solutions: Pointer to the number of solutions.
+ * - sudoku, solutions, max_solutions, n_solutions: As in `solve_sudoku`.
+ * - depth: Depth of the call in the search (1 for the root), for the instrumentation counters.
  * 
  * Returns:
- * - true if the puzzle is solved,
+ * - true if max_solutions solutions were found,
  *   false otherwise.
  */
-bool solve_sudoku(
+static bool solve_recursive(
     Sudoku *sudoku,
+    Sudoku *solutions,
+    int max_solutions,
     int *n_solutions,
-    char *output_path
+    int depth
 ) {
     int row, col;
 
-    // Update the number of solutions and save the current one if found
+    // Update the number of solutions and keep a copy of the current one
+    count_node(depth);
     if (!find_empty(sudoku, &row, &col)) {
+        memcpy(&solutions[*n_solutions], sudoku, sizeof(Sudoku));
         (*n_solutions)++;
-        char filename[256];
-
-        snprintf(filename, sizeof(filename), "%s" PATH_SEPARATOR "solution%d.txt", output_path, *n_solutions);
-        write_to_file(sudoku, filename);
-        
-        if (*n_solutions == N_SOL) {
-            return true;
-        }
-        return false;
+        return *n_solutions == max_solutions;
     }
     for (int guess = 1; guess <= 9; guess++) {
         if (is_valid(sudoku, guess, row, col)) {
             sudoku->table[row][col] = guess;
-            if (solve_sudoku(sudoku, n_solutions, output_path)) {
-                if (*n_solutions == N_SOL) {
-                    return true;
-                }
+            if (solve_recursive(sudoku, solutions, max_solutions, n_solutions, depth + 1)) {
+                return true;
             }
             // Backtrack if the guess was incorrect
+            count_backtrack();
             sudoku->table[row][col] = 0;
         }
     }
@@ -67,10 +66,75 @@ bool solve_sudoku(
 }
 
 
+/**
+ * Function: solve_sudoku
+ * ----------------------
+ * Solve the Sudoku puzzle using the backtracking algorithm, collecting the solutions in memory.
+ * 
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku structure.
+ * - solutions: Array receiving up to max_solutions solved grids.
+ * - max_solutions: Number of solutions after which the search stops.
+ * - n_solutions: Pointer to the number of solutions.
+ * 
+ * Returns:
+ * - true if max_solutions solutions were found,
+ *   false otherwise.
+ */
+bool solve_sudoku(
+    Sudoku *sudoku,
+    Sudoku *solutions,
+    int max_solutions,
+    int *n_solutions
+) {
+    TRACE_SCOPE("solve_sudoku");
+    return solve_recursive(sudoku, solutions, max_solutions, n_solutions, 1);
+}
+
+
+/**
+ * Function: write_solutions
+ * -------------------------
+ * Write the solutions found by the search, once it is over.
+ * With output path "-" they are streamed to stdout as 81-digit lines in a single write,
+ * otherwise each one is saved to <output_path>/solutionN.txt as expected by the GUI.
+ * 
+ * Parameters:
+ * - solutions: Array of solved grids.
+ * - n_solutions: Number of solutions in the array.
+ * - output_path: Folder receiving the files, or "-" for stdout.
+ */
+void write_solutions(
+    Sudoku *solutions,
+    int n_solutions,
+    char *output_path
+) {
+    if (strcmp(output_path, "-") == 0) {
+        char buffer[N_SOL * LINE_TEXT_SIZE];
+        size_t length = 0;
+        for (int k = 0; k < n_solutions; k++) {
+            length += format_sudoku(&solutions[k], FORMAT_LINE, buffer + length);
+        }
+        fwrite(buffer, 1, length, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    for (int k = 0; k < n_solutions; k++) {
+        char filename[256];
+        snprintf(filename, sizeof(filename), "%s" PATH_SEPARATOR "solution%d.txt", output_path, k + 1);
+        write_to_file(&solutions[k], filename);
+    }
+}
+
+
 // ---------------------------------------------------------------------------------------------------- //
 // --- MAIN FUNCTION --- //
 
 
+// Programs linking the solver (run_bench.exe) are built without the entry point
+#ifndef SUDOKU_LIBRARY
+
 /**
  * Function: main
  * --------------
@@ -80,19 +144,153 @@ bool solve_sudoku(
  * - Print the initial grid.
  * - Validate it.
  * - Attempts to solve it.
+ * - Write the solutions to files, or to stdout when the output path is "-".
  * - Print the number of solutions found (it can be at most N_SOL).
+ *
+ * With `--batch` it instead streams puzzles in the one-line format (81 characters, '0' or '.' for the
+ * empty cells) from a file or stdin, and writes for each one its first solution, or with `--count`
+ * its number of solutions (up to N_SOL), one line per puzzle (see batch.c).
+ * The puzzles are spread over `--threads` workers (all the cores by default); results are written as soon
+ * as they are ready, or in input order with `--ordered`. Packed puzzle files (see io.c) are accepted as well,
+ * from stdin and with `--pipeline` too.
+ * With `--pipeline` the input is always streamed, through a parser thread, the solver threads and a writer thread
+ * connected by bounded queues, so that reading and writing overlap with solving.
+ *
+ * With `--pack` and `--unpack` it converts puzzles between the one-line format and the packed format.
+ *
+ * With `--trace FILE` the solves are recorded as a Chrome trace-event JSON file (see trace.c).
  */
 int main(
     int argc,
     char *argv[]
 ) {
+    const char *usage = "Usage: %s <input_file> <output_path | -> <log_path> [--trace FILE]\n"
+                        "       %s --batch <puzzles_file | -> [--count] [--out FILE] [--threads N] [--ordered] [--pipeline] [--trace FILE]\n"
+                        "       %s --pack <text_file | -> <packed_file> | --unpack <packed_file> <text_file | ->\n";
+
+    // Batch mode: stream one-line puzzles from a file or stdin
+    if (argc >= 3 && strcmp(argv[1], "--batch") == 0) {
+        BatchMode mode = BATCH_SOLVE;
+        char *out_file = NULL;
+        int n_threads = thread_pool_default_size();
+        bool ordered = false;
+        bool pipeline = false;
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "--count") == 0) {
+                mode = BATCH_COUNT;
+            } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                n_threads = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--ordered") == 0) {
+                ordered = true;
+            } else if (strcmp(argv[i], "--pipeline") == 0) {
+                pipeline = true;
+            } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+                out_file = argv[++i];
+            } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                if (!trace_open(argv[++i])) {
+                    printf("Error creating the trace file '%s'\n", argv[i]);
+                    return 1;
+                }
+            } else {
+                printf(usage, argv[0], argv[0], argv[0]);
+                return 1;
+            }
+        }
+
+        // Regular files are mapped and parsed in place, anything else (stdin, pipes) is streamed
+        MappedFile mapped;
+        bool is_mapped = !pipeline && strcmp(argv[2], "-") != 0 && map_file(&mapped, argv[2]);
+        FILE *in = stdin;
+        if (!is_mapped && strcmp(argv[2], "-") != 0) {
+            in = fopen(argv[2], "rb");
+            if (in == NULL) {
+                printf("Error opening file '%s'\n", argv[2]);
+                return 1;
+            }
+        }
+        FILE *out = stdout;
+        if (out_file != NULL) {
+            out = fopen(out_file, "w");
+            if (out == NULL) {
+                printf("Error creating file '%s'\n", out_file);
+                return 1;
+            }
+        }
+
+        BatchSummary summary;
+        if (is_mapped) {
+            summary = solve_batch_mapped(&mapped, out, mode, n_threads, ordered);
+            unmap_file(&mapped);
+        } else {
+            if (pipeline) {
+                summary = solve_batch_pipeline(in, out, mode, n_threads, ordered);
+            } else {
+                summary = (n_threads > 1) ? solve_batch_parallel(in, out, mode, n_threads, ordered)
+                                          : solve_batch(in, out, mode);
+            }
+            if (in != stdin) fclose(in);
+        }
+        fprintf(stderr, "%ld puzzles, %ld invalid, %ld without solution\n",
+                summary.puzzles, summary.invalid, summary.unsolvable);
+        // Buffered write errors may only show up when the output is flushed
+        bool write_failed = ferror(out);
+        if (((out != stdout) ? fclose(out) : fflush(stdout)) != 0) {
+            write_failed = true;
+        }
+        if (write_failed) {
+            fprintf(stderr, "Error writing '%s'\n", (out_file != NULL) ? out_file : "-");
+            return 1;
+        }
+        return 0;
+    }
+
+    // Conversion between the one-line format and the packed format
+    if (argc == 4 && (strcmp(argv[1], "--pack") == 0 || strcmp(argv[1], "--unpack") == 0)) {
+        bool pack = strcmp(argv[1], "--pack") == 0;
+        FILE *in = (pack && strcmp(argv[2], "-") == 0) ? stdin : fopen(argv[2], pack ? "r" : "rb");
+        if (in == NULL) {
+            printf("Error opening file '%s'\n", argv[2]);
+            return 1;
+        }
+        FILE *out = (!pack && strcmp(argv[3], "-") == 0) ? stdout : fopen(argv[3], pack ? "wb" : "w");
+        if (out == NULL) {
+            printf("Error creating file '%s'\n", argv[3]);
+            return 1;
+        }
+
+        long skipped;
+        long count = pack ? convert_to_packed(in, out, &skipped) : convert_to_text(in, out, &skipped);
+        bool write_failed = ferror(out);
+        if (in != stdin) fclose(in);
+        if (((out != stdout) ? fclose(out) : fflush(stdout)) != 0) {
+            write_failed = true;
+        }
+        if (write_failed) {
+            fprintf(stderr, "Error writing '%s'\n", argv[3]);
+            return 1;
+        }
+        if (count < 0) {
+            fprintf(stderr, "'%s' is not a packed puzzle file\n", argv[2]);
+            return 1;
+        }
+        fprintf(stderr, "%ld puzzles converted, %ld malformed skipped\n", count, skipped);
+        return 0;
+    }
 
-    if (argc != 4) {
-        printf("Usage: %s <input_file> <output_path> <log_path>\n", argv[0]);
+    if (argc != 4 && !(argc == 6 && strcmp(argv[4], "--trace") == 0)) {
+        printf(usage, argv[0], argv[0], argv[0]);
+        return 1;
+    }
+    if (argc == 6 && !trace_open(argv[5])) {
+        printf("Error creating the trace file '%s'\n", argv[5]);
         return 1;
     }
     Sudoku sudoku;
-    parse_file(&sudoku, argv[1]);
+    ParseResult parsed = parse_file(&sudoku, argv[1]);
+    if (parsed.error != PARSE_OK) {
+        report_parse_error(argv[1], parsed);
+        return 1;
+    }
 
     Sudoku sudoku_copy;
     memcpy(&sudoku_copy, &sudoku, sizeof(Sudoku));
@@ -115,8 +313,16 @@ int main(
         }
     }
 
+    // With -DSOLVER_COUNTERS the counters of both solves are reported on stderr
+    Sudoku solutions[N_SOL];
     int n_solutions = 0;
-    solve_sudoku(&sudoku, &n_solutions, argv[2]);
+    counters_attach(&stats_copy);
+    solve_sudoku(&sudoku, solutions, N_SOL, &n_solutions);
+    counters_attach(NULL);
+    print_counters(stderr, &stats_copy);
+    write_solutions(solutions, n_solutions, argv[2]);
     // printf("Found %d solutions out of %d\n", n_solutions, N_SOL);
     return 0;
-}
\ No newline at end of file
+}
+
+#endif
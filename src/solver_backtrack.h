@@ -0,0 +1,11 @@
+#ifndef SOLVER_BACKTRACK_H
+#define SOLVER_BACKTRACK_H
+
+#include "io.h"
+#include <stdbool.h>
+
+bool solve_sudoku(Sudoku *sudoku, Sudoku *solutions, int max_solutions, int *n_solutions);
+
+void write_solutions(Sudoku *solutions, int n_solutions, char *output_path);
+
+#endif
@@ -0,0 +1,180 @@
+#include "solver_bitmask.h"
+#include "solver_human.h"
+#include "trace.h"
+#include <stdbool.h>
+#include <time.h>
+
+#define TIMEOUT_SECONDS 1
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- UNIQUE SOLUTION CHECKER --- //
+
+
+/**
+ * Function: count_solutions_recursive
+ * -----------------------------------
+ * Helper function that recursively counts the number of solutions for a given Sudoku puzzle using backtracking.
+ * Digits used by each row, column and box are kept as bitmasks, and the search always branches on the empty cell
+ * with the fewest candidates, which keeps the search tree small even for puzzles with few givens.
+ * Tracks the number of trials (search steps) and ensures computation stays within a given timeout.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid.
+ * - masks: Digits used by each row (masks[0]), column (masks[1]) and box (masks[2]).
+ * - n_solutions: Pointer to a variable that tracks the number of solutions found.
+ * - trials: Pointer to a variable that tracks the number of search steps.
+ * - start_time: The clock time when the function was called in dynamic_dig, used for timeout checks.
+ * - solutions: Array receiving the first N_SOL solutions found, or NULL to only count them.
+ * - depth: Depth of the call in the search (1 for the root), for the instrumentation counters.
+
+ * Returns:
+ * - The total number of solutions found.
+ */
+static int count_solutions_recursive(
+    Sudoku *sudoku,
+    unsigned short masks[3][N],
+    int *n_solutions,
+    long *trials,
+    time_t start_time,
+    Sudoku *solutions,
+    int depth
+) {
+    count_node(depth);
+    time_t current_time = time(NULL);
+    double elapsed_time = ((double)(current_time - start_time)) / CLOCKS_PER_SEC;
+    if(elapsed_time > TIMEOUT_SECONDS) {
+        // printf("\nTimeout exceeded during grid generation!\n");
+        return false;
+    }
+
+    // Find the most constrained empty cell
+    int row = -1, col = -1, n_candidates = 10;
+    unsigned short candidates = 0;
+    for(int r = 0; r < N && n_candidates > 1; r++) {
+        for(int c = 0; c < N; c++) {
+            if(sudoku->table[r][c] != 0) continue;
+            unsigned short mask = ~(masks[0][r] | masks[1][c] | masks[2][(r/3)*3 + c/3]) & 0x1FF;
+            int count = __builtin_popcount(mask);
+            if(count < n_candidates) {
+                row = r;
+                col = c;
+                n_candidates = count;
+                candidates = mask;
+                if(count <= 1) break;
+            }
+        }
+    }
+
+    if(row == -1) {
+        if(solutions != NULL) {
+            solutions[*n_solutions] = *sudoku;
+        }
+        (*n_solutions)++;
+        return *n_solutions;
+    }
+    for(int guess = 1; guess <= 9; guess++) {
+        unsigned short bit = 1U << (guess - 1);
+        if(!(candidates & bit)) continue;
+        (*trials)++;
+        count_propagation();
+        sudoku->table[row][col] = guess;
+        masks[0][row] |= bit;
+        masks[1][col] |= bit;
+        masks[2][(row/3)*3 + col/3] |= bit;
+        if(count_solutions_recursive(sudoku, masks, n_solutions, trials, start_time, solutions, depth + 1) == N_SOL) {
+            return N_SOL;
+        }
+        count_backtrack();
+        sudoku->table[row][col] = 0;
+        masks[0][row] &= ~bit;
+        masks[1][col] &= ~bit;
+        masks[2][(row/3)*3 + col/3] &= ~bit;
+    }
+    return *n_solutions;
+}
+
+
+/**
+ * Function: search_solutions
+ * --------------------------
+ * Finds the solutions of a Sudoku puzzle, up to N_SOL, using the recursive helper function `count_solutions_recursive`,
+ * and reports the size of the search. Includes timeout management to prevent excessive computation.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid (left partially filled when N_SOL solutions are found).
+ * - solutions: Array of N_SOL grids receiving the solutions, or NULL to only count them.
+ * - start_time: The clock time when the function was called in dynamic_dig, used for timeout checks.
+ * - nodes: Pointer receiving the number of search steps (guesses placed), or NULL.
+
+ * Returns:
+ * - The number of solutions found, at most N_SOL. If the timeout is exceeded, the count may be incomplete.
+ */
+int search_solutions(
+    Sudoku *sudoku,
+    Sudoku *solutions,
+    time_t start_time,
+    long *nodes
+) {
+    int n_solutions = 0;
+    long trials = 0;
+    unsigned short masks[3][N] = {{0}};
+    for(int r = 0; r < N; r++) {
+        for(int c = 0; c < N; c++) {
+            if(sudoku->table[r][c] != 0) {
+                unsigned short bit = 1U << (sudoku->table[r][c] - 1);
+                masks[0][r] |= bit;
+                masks[1][c] |= bit;
+                masks[2][(r/3)*3 + c/3] |= bit;
+            }
+        }
+    }
+    int result = count_solutions_recursive(sudoku, masks, &n_solutions, &trials, start_time, solutions, 1);
+    if(nodes != NULL) {
+        *nodes = trials;
+    }
+    return result;
+}
+
+
+/**
+ * Function: find_solutions
+ * ------------------------
+ * Finds the solutions of a Sudoku puzzle, up to N_SOL, with `search_solutions`.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid (left partially filled when N_SOL solutions are found).
+ * - solutions: Array of N_SOL grids receiving the solutions, or NULL to only count them.
+ * - start_time: The clock time when the function was called in dynamic_dig, used for timeout checks.
+
+ * Returns:
+ * - The number of solutions found, at most N_SOL. If the timeout is exceeded, the count may be incomplete.
+ */
+int find_solutions(
+    Sudoku *sudoku,
+    Sudoku *solutions,
+    time_t start_time
+) {
+    return search_solutions(sudoku, solutions, start_time, NULL);
+}
+
+
+/**
+ * Function: count_solutions
+ * -------------------------
+ * Counts the number of solutions for a given Sudoku puzzle, up to N_SOL, with `find_solutions`.
+
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid.
+ * - start_time: The clock time when the function was called in dynamic_dig, used for timeout checks.
+
+ * Returns:
+ * - The total number of solutions for the Sudoku grid. If the timeout is exceeded, the count may be incomplete.
+ */
+int count_solutions(
+    Sudoku *sudoku,
+    time_t start_time
+) {
+    TRACE_SCOPE("count_solutions");
+    return find_solutions(sudoku, NULL, start_time);
+}
@@ -0,0 +1,15 @@
+#ifndef SOLVER_BITMASK_H
+#define SOLVER_BITMASK_H
+
+#include "io.h"
+#include <time.h>
+
+#define N_SOL 5
+
+int search_solutions(Sudoku *sudoku, Sudoku *solutions, time_t start_time, long *nodes);
+
+int find_solutions(Sudoku *sudoku, Sudoku *solutions, time_t start_time);
+
+int count_solutions(Sudoku *sudoku, time_t start_time);
+
+#endif
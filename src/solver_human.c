@@ -1,6 +1,8 @@
 #include "io.h"
 #include "solver_human.h"
 #include "helpers.h"
+#include "trace.h"
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -14,11 +16,46 @@
     #define PATH_SEPARATOR "/"
 #endif
 
+#if defined(SOLVER_COUNTERS) && defined(_WIN32)
+    #include <windows.h>
+#elif defined(SOLVER_COUNTERS)
+    #include <time.h>
+#endif
+
 // ---------------------------------------------------------------------------------------------------- //
 // --- HELPER FUNCTIONS --- //
 
-// Global candidates array
-static unsigned short candidates[N][N];
+// Candidates of every cell, as digit bitmasks. Each solve owns its array, so that solves are independent
+typedef unsigned short Candidates[N][N];
+
+
+/**
+ * Function: log_printf
+ * --------------------
+ * Appends a formatted message to the log of the solve: to its file if it has one,
+ * and to its buffer if it has one. A full buffer keeps the beginning of the log.
+ *
+ * Parameters:
+ * - log: Pointer to the SolverLog structure.
+ * - format: printf-style format of the message.
+ */
+static void log_printf(SolverLog *log, const char *format, ...) {
+    va_list args;
+    if (log->file != NULL) {
+        va_start(args, format);
+        vfprintf(log->file, format, args);
+        va_end(args);
+    }
+    if (log->buffer != NULL && log->length + 1 < log->capacity) {
+        va_start(args, format);
+        int written = vsnprintf(log->buffer + log->length, log->capacity - log->length, format, args);
+        va_end(args);
+        if (written > 0) {
+            log->length += (size_t)written;
+            if (log->length >= log->capacity) log->length = log->capacity - 1;
+        }
+    }
+}
 
 
 /**
@@ -101,6 +138,7 @@ static int bitCount(unsigned short mask) {
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - r: The row index of the cell to update.
  * - c: The column index of the cell to update.
  * - d: The digit to place in the cell.
@@ -108,11 +146,12 @@ static int bitCount(unsigned short mask) {
  * Returns:
  * - Nothing. Modifies the `sudoku` grid and the `candidates` array in place.
  */
-static void setCell(Sudoku *sudoku, int r, int c, int d) {
+static void setCell(Sudoku *sudoku, Candidates candidates, int r, int c, int d) {
     // printf("Setting cell (%d, %d) to %d\n", r, c, d);
 
     // Update the Sudoku grid.
     sudoku->table[r][c] = d;
+    count_propagation();
 
     // Clear candidates for the current cell.
     candidates[r][c] = 0;
@@ -152,11 +191,12 @@ static void setCell(Sudoku *sudoku, int r, int c, int d) {
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Array receiving the candidates of the cells.
  *
  * Returns:
- * - Nothing. Initializes the global `candidates` array.
+ * - Nothing. Initializes the `candidates` array.
  */
-static void initCandidates(Sudoku *sudoku) {
+static void initCandidates(Sudoku *sudoku, Candidates candidates) {
     // Reset all candidates to "all digits possible."
     for (int r = 0; r < N; r++) {
         for (int c = 0; c < N; c++) {
@@ -170,7 +210,7 @@ static void initCandidates(Sudoku *sudoku) {
             if (sudoku->table[r][c] != 0) {
                 int givenDigit = sudoku->table[r][c];
                 // printf("Initializing given cell (%d, %d) with digit %d\n", r, c, givenDigit);
-                setCell(sudoku, r, c, givenDigit);
+                setCell(sudoku, candidates, r, c, givenDigit);
             }
         }
     }
@@ -195,13 +235,15 @@ static void initCandidates(Sudoku *sudoku) {
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyNakedSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyNakedSingle(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     for (int r = 0; r < N; r++) {
         for (int c = 0; c < N; c++) {
@@ -210,16 +252,10 @@ bool applyNakedSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                 if (bitCount(mask) == 1) { // Only one candidate
                     for (int d = 1; d <= 9; d++) {
                         if (maskHasDigit(mask, d)) {
-                            setCell(sudoku, r, c, d);
+                            setCell(sudoku, candidates, r, c, d);
                             stats->naked_single++;
                             if (solving_mode) {
-                                FILE *logFile = fopen(log_file, "a");
-                                if (logFile == NULL) {
-                                    printf("Error opening log file.\n");
-                                    return false; // Exit if the log file cannot be opened
-                                }
-                                fprintf(logFile, "Naked Single: placing %d in cell (%d, %d)\n\n", d, r+1, c+1);
-                                fclose(logFile); // Close the file before returning
+                                log_printf(log, "Naked Single: placing %d in cell (%d, %d)\n\n", d, r+1, c+1);
                             }
                             return true;
                         }
@@ -240,13 +276,15 @@ bool applyNakedSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyHiddenSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyHiddenSingle(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     // Check rows for hidden singles
     for (int r = 0; r < N; r++) {
@@ -259,16 +297,10 @@ bool applyHiddenSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                 }
             }
             if (count == 1) { // Only one cell in row can take this digit
-                setCell(sudoku, r, col, d);
+                setCell(sudoku, candidates, r, col, d);
                 stats->hidden_single++;
                 if (solving_mode) {
-                    FILE *logFile = fopen(log_file, "a");
-                    if (logFile == NULL) {
-                        printf("Error opening log file.\n");
-                        return false; // Exit if the log file cannot be opened
-                    }
-                    fprintf(logFile, "Hidden Single (Row): placing %d in cell (%d, %d)\n\n", d, r+1, col+1);
-                    fclose(logFile); // Close the file before returning
+                    log_printf(log, "Hidden Single (Row): placing %d in cell (%d, %d)\n\n", d, r+1, col+1);
                 }
                 return true;
             }
@@ -286,16 +318,10 @@ bool applyHiddenSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                 }
             }
             if (count == 1) { // Only one cell in column can take this digit
-                setCell(sudoku, row, c, d);
+                setCell(sudoku, candidates, row, c, d);
                 stats->hidden_single++;
                 if (solving_mode) {
-                    FILE *logFile = fopen(log_file, "a");
-                    if (logFile == NULL) {
-                        printf("Error opening log file.\n");
-                        return false; // Exit if the log file cannot be opened
-                    }
-                    fprintf(logFile, "Hidden Single (Column): placing %d in cell (%d, %d)\n\n", d, row+1, c+1);
-                    fclose(logFile); // Close the file before returning
+                    log_printf(log, "Hidden Single (Column): placing %d in cell (%d, %d)\n\n", d, row+1, c+1);
                 }
                 return true;
             }
@@ -320,16 +346,10 @@ bool applyHiddenSingle(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                     }
                 }
                 if (count == 1) { // Only one cell in box can take this digit
-                    setCell(sudoku, row, col, d);
+                    setCell(sudoku, candidates, row, col, d);
                     stats->hidden_single++;
                     if (solving_mode) {
-                        FILE *logFile = fopen(log_file, "a");
-                        if (logFile == NULL) {
-                            printf("Error opening log file.\n");
-                            return false; // Exit if the log file cannot be opened
-                        }
-                        fprintf(logFile, "Hidden Single (Box): placing %d in cell (%d, %d)\n\n", d, row+1, col+1);
-                        fclose(logFile); // Close the file before returning
+                        log_printf(log, "Hidden Single (Box): placing %d in cell (%d, %d)\n\n", d, row+1, col+1);
                     }
                     return true;
                 }
@@ -370,13 +390,15 @@ bool isNakedPair(unsigned short mask1, unsigned short mask2) {
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyNakedPair(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     bool progress = false;
 
@@ -392,15 +414,9 @@ bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                             if (c3 != c1 && c3 != c2 && sudoku->table[r][c3] == 0) {
                                 if (candidates[r][c3] & pairMask) {
                                     if (solving_mode) {
-                                        FILE *logFile = fopen(log_file, "a");
-                                        if (logFile == NULL) {
-                                            printf("Error opening log file.\n");
-                                            return false; // Exit if the log file cannot be opened
-                                        }
                                         char candidatesStr[10];
                                         formatCandidates(candidatesStr, candidates[r][c3] & pairMask);
-                                        fprintf(logFile, "Naked pair at cells (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r+1, c1+1, r+1, c2+1, candidatesStr, r+1, c3+1);
-                                        fclose(logFile); // Close the file before returning
+                                        log_printf(log, "Naked pair at cells (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r+1, c1+1, r+1, c2+1, candidatesStr, r+1, c3+1);
                                     }
                                     candidates[r][c3] &= ~pairMask;
                                     progress = true;
@@ -409,9 +425,7 @@ bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                         }
                         if (progress) {
                             if (solving_mode) {
-                                FILE *logFile = fopen(log_file, "a");
-                                fprintf(logFile,"\n");
-                                fclose(logFile);
+                                log_printf(log,"\n");
                             }
                             stats->naked_pair++;
                             return progress;
@@ -434,15 +448,9 @@ bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                             if (r3 != r1 && r3 != r2 && sudoku->table[r3][c] == 0) {
                                 if (candidates[r3][c] & pairMask) {
                                     if (solving_mode) {
-                                        FILE *logFile = fopen(log_file, "a");
-                                        if (logFile == NULL) {
-                                            printf("Error opening log file.\n");
-                                            return false; // Exit if the log file cannot be opened
-                                        }
                                         char candidatesStr[10];
                                         formatCandidates(candidatesStr, candidates[r3][c] & pairMask);
-                                        fprintf(logFile, "Naked pair at cells (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r1+1, c+1, r2+1, c+1, candidatesStr, r3+1, c+1);
-                                        fclose(logFile); // Close the file before returning
+                                        log_printf(log, "Naked pair at cells (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r1+1, c+1, r2+1, c+1, candidatesStr, r3+1, c+1);
                                     }                                
                                     candidates[r3][c] &= ~pairMask;
                                     progress = true;
@@ -451,9 +459,7 @@ bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                         }
                         if (progress) {
                             if (solving_mode) {
-                                FILE *logFile = fopen(log_file, "a");
-                                fprintf(logFile,"\n");
-                                fclose(logFile);
+                                log_printf(log,"\n");
                             }
                             stats->naked_pair++;
                             return progress;
@@ -495,15 +501,9 @@ bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                                 int r = cells[k][0], c = cells[k][1];
                                 if (candidates[r][c] & pairMask) {
                                     if (solving_mode) {
-                                        FILE *logFile = fopen(log_file, "a");
-                                        if (logFile == NULL) {
-                                            printf("Error opening log file.\n");
-                                            return false; // Exit if the log file cannot be opened
-                                        }
                                         char candidatesStr[10];
                                         formatCandidates(candidatesStr, candidates[r][c] & pairMask);
-                                        fprintf(logFile, "Naked pair at cells (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", cells[i][0]+1, cells[i][1]+1, cells[j][0]+1, cells[j][1]+1, candidatesStr, r+1, c+1);
-                                        fclose(logFile); // Close the file before returning
+                                        log_printf(log, "Naked pair at cells (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", cells[i][0]+1, cells[i][1]+1, cells[j][0]+1, cells[j][1]+1, candidatesStr, r+1, c+1);
                                     }                                  
                                     candidates[r][c] &= ~pairMask;
                                     progress = true;
@@ -512,9 +512,7 @@ bool applyNakedPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                         }
                         if (progress) {
                             if (solving_mode) {
-                                FILE *logFile = fopen(log_file, "a");
-                                fprintf(logFile,"\n");
-                                fclose(logFile);
+                                log_printf(log,"\n");
                             }
                             stats->naked_pair++;
                             return progress;
@@ -572,6 +570,7 @@ void removeOtherCandidates(unsigned short *cellMask, unsigned short pairMask) {
  * (row, column, or box).
  *
  * Parameters:
+ * - candidates: Candidates of the cells of the puzzle.
  * - d: The candidate digit to check.
  * - unitCells: An array of all cells in the unit.
  * - pairCells: The two cells that are being checked as a pair.
@@ -580,7 +579,7 @@ void removeOtherCandidates(unsigned short *cellMask, unsigned short pairMask) {
  * Returns:
  * - true if the digit is unique to the two cells, false otherwise.
  */
-bool isUniqueToPair(int d, int unitCells[9][2], int pairCells[2][2], int unitSize) {
+bool isUniqueToPair(Candidates candidates, int d, int unitCells[9][2], int pairCells[2][2], int unitSize) {
     for (int i = 0; i < unitSize; i++) {
         int r = unitCells[i][0], c = unitCells[i][1];
         if ((r != pairCells[0][0] || c != pairCells[0][1]) && 
@@ -602,13 +601,15 @@ bool isUniqueToPair(int d, int unitCells[9][2], int pairCells[2][2], int unitSiz
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyHiddenPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyHiddenPair(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     bool progress = false;
 
@@ -655,8 +656,8 @@ bool applyHiddenPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
 
                     // Validate if it forms a hidden pair
                     if (pairCount == 2 &&
-                        isUniqueToPair(d1, unitCells, pairCells, unitSize) &&
-                        isUniqueToPair(d2, unitCells, pairCells, unitSize)) {
+                        isUniqueToPair(candidates, d1, unitCells, pairCells, unitSize) &&
+                        isUniqueToPair(candidates, d2, unitCells, pairCells, unitSize)) {
                         
                         // Check if the candidate masks are already reduced
                         int r1 = pairCells[0][0], c1 = pairCells[0][1];
@@ -671,13 +672,7 @@ bool applyHiddenPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
                         removeOtherCandidates(&candidates[r2][c2], pairMask);
 
                         if (solving_mode) {
-                            FILE *logFile = fopen(log_file, "a");
-                            if (logFile == NULL) {
-                                printf("Error opening log file.\n");
-                                return false; // Exit if the log file cannot be opened
-                            }
-                            fprintf(logFile, "Hidden Pair [%d, %d] in cells (%d, %d) and (%d, %d): cleared other candidates in these cells\n\n", d1, d2, r1+1, c1+1, r2+1, c2+1);
-                            fclose(logFile); // Close the file before returning
+                            log_printf(log, "Hidden Pair [%d, %d] in cells (%d, %d) and (%d, %d): cleared other candidates in these cells\n\n", d1, d2, r1+1, c1+1, r2+1, c2+1);
                         }
                         progress = true;
                         stats->hidden_pair++;
@@ -703,13 +698,15 @@ bool applyHiddenPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyPointingPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyPointingPair(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     bool progress = false;
 
@@ -765,22 +762,14 @@ bool applyPointingPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                                             candidates[r][cc] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile, "Pointing Pair (Row Outside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, r+1, cc+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log, "Pointing Pair (Row Outside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, r+1, cc+1);
                                             }
                                         }
                                     }
                                 }
                                 if (progress) {
                                     if (solving_mode) {
-                                        FILE *logFile = fopen(log_file, "a");
-                                        fprintf(logFile,"\n");
-                                        fclose(logFile);
+                                        log_printf(log,"\n");
                                     }
                                     stats->pointing_pair++;
                                     return progress;
@@ -804,22 +793,14 @@ bool applyPointingPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                                             candidates[innerR][innerC] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile, "Pointing Pair (Row Inside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, innerR+1, innerC+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log, "Pointing Pair (Row Inside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, innerR+1, innerC+1);
                                             }
                                         }
                                     }
                                 }
                                 if (progress) {
                                     if (solving_mode) {
-                                        FILE *logFile = fopen(log_file, "a");
-                                        fprintf(logFile,"\n");
-                                        fclose(logFile);
+                                        log_printf(log,"\n");
                                     }
                                     stats->pointing_pair++;
                                     return progress;
@@ -862,21 +843,15 @@ bool applyPointingPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                                             candidates[rr][c] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile, "Pointing Pair (Col Outside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, rr+1, c+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log, "Pointing Pair (Col Outside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, rr+1, c+1);
                                             }
                                         }
                                     }
                                 }
                                 if (progress) {
-                                    FILE *logFile = fopen(log_file, "a");
-                                    fprintf(logFile,"\n");
-                                    fclose(logFile);
+                                    if (solving_mode) {
+                                        log_printf(log,"\n");
+                                    }
                                     stats->pointing_pair++;
                                     return progress;
                                 }
@@ -899,22 +874,14 @@ bool applyPointingPair(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
                                             candidates[innerR][innerC] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile,"Pointing Pair (Col Inside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, innerR+1, innerC+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log,"Pointing Pair (Col Inside Box) at cells (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow+1, otherCol+1, d, innerR+1, innerC+1);
                                             }
                                         }
                                     }
                                 }
                                 if (progress) {
                                     if (solving_mode) {
-                                        FILE *logFile = fopen(log_file, "a");
-                                        fprintf(logFile,"\n");
-                                        fclose(logFile);
+                                        log_printf(log,"\n");
                                     }
                                     stats->pointing_pair++;
                                     return progress;
@@ -964,13 +931,15 @@ bool isNakedTriple(unsigned short mask1, unsigned short mask2, unsigned short ma
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyNakedTriple(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
     bool progress = false;
 
     // Check rows for Naked Triples
@@ -988,15 +957,9 @@ bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                                         if (c != c1 && c != c2 && c != c3 && sudoku->table[r][c] == 0) {
                                             if (candidates[r][c] & tripleMask) {
                                                 if (solving_mode) {
-                                                    FILE *logFile = fopen(log_file, "a");
-                                                    if (logFile == NULL) {
-                                                        printf("Error opening log file.\n");
-                                                        return false; // Exit if the log file cannot be opened
-                                                    }
                                                     char candidatesStr[10];
                                                     formatCandidates(candidatesStr, candidates[r][c] & tripleMask);
-                                                    fprintf(logFile, "Naked triple at cells (%d, %d), (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r+1, c1+1, r+1, c2+1, r+1, c3+1, candidatesStr, r+1, c+1);
-                                                    fclose(logFile); // Close the file before returning
+                                                    log_printf(log, "Naked triple at cells (%d, %d), (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r+1, c1+1, r+1, c2+1, r+1, c3+1, candidatesStr, r+1, c+1);
                                                 }   
 
                                                 candidates[r][c] &= ~tripleMask;
@@ -1006,9 +969,7 @@ bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                                     }
                                     if (progress){
                                         if (solving_mode) {
-                                            FILE *logFile = fopen(log_file, "a");
-                                            fprintf(logFile,"\n");
-                                            fclose(logFile);
+                                            log_printf(log,"\n");
                                         }
                                         stats->naked_triple++;
                                         return progress;
@@ -1037,15 +998,9 @@ bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                                         if (r != r1 && r != r2 && r != r3 && sudoku->table[r][c] == 0) {
                                             if (candidates[r][c] & tripleMask) {
                                                 if (solving_mode) {
-                                                    FILE *logFile = fopen(log_file, "a");
-                                                    if (logFile == NULL) {
-                                                        printf("Error opening log file.\n");
-                                                        return false; // Exit if the log file cannot be opened
-                                                    }
                                                     char candidatesStr[10];
                                                     formatCandidates(candidatesStr, candidates[r][c] & tripleMask);
-                                                    fprintf(logFile, "Naked triple at cells (%d, %d), (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r1+1, c+1, r2+1, c+1, r3+1, c+1, candidatesStr, r+1, c+1);
-                                                    fclose(logFile); // Close the file before returning
+                                                    log_printf(log, "Naked triple at cells (%d, %d), (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", r1+1, c+1, r2+1, c+1, r3+1, c+1, candidatesStr, r+1, c+1);
                                                 }   
 
                                                 candidates[r][c] &= ~tripleMask;
@@ -1055,9 +1010,7 @@ bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                                     }
                                     if (progress){
                                         if (solving_mode) {
-                                            FILE *logFile = fopen(log_file, "a");
-                                            fprintf(logFile,"\n");
-                                            fclose(logFile);
+                                            log_printf(log,"\n");
                                         }
                                         stats->naked_triple++;
                                         return progress;
@@ -1104,16 +1057,10 @@ bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                                     int r = cells[m][0], c = cells[m][1];
                                     if (candidates[r][c] & tripleMask) {
                                         if (solving_mode) {
-                                            FILE *logFile = fopen(log_file, "a");
-                                            if (logFile == NULL) {
-                                                printf("Error opening log file.\n");
-                                                return false; // Exit if the log file cannot be opened
-                                            }
                                             char candidatesStr[10];
                                             formatCandidates(candidatesStr, candidates[r][c] & tripleMask);
-                                            fprintf(logFile, "Naked triple at cells (%d, %d), (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", 
+                                            log_printf(log, "Naked triple at cells (%d, %d), (%d, %d) and (%d, %d): removing candidates %s from cell (%d, %d)\n", 
                                                         cells[i][0]+1, cells[i][1]+1, cells[j][0]+1, cells[j][1]+1, cells[k][0]+1, cells[k][1]+1, candidatesStr, r+1, c+1);
-                                            fclose(logFile); // Close the file before returning
                                         }
 
                                         candidates[r][c] &= ~tripleMask;
@@ -1123,9 +1070,7 @@ bool applyNakedTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, cha
                             }
                             if (progress){
                                 if (solving_mode) {
-                                    FILE *logFile = fopen(log_file, "a");
-                                    fprintf(logFile,"\n");
-                                    fclose(logFile);
+                                    log_printf(log,"\n");
                                 }
                                 stats->naked_triple++;
                                 return progress;
@@ -1189,13 +1134,15 @@ void removeOtherCandidatesForTriple(unsigned short *cellMask, unsigned short tri
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyHiddenTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyHiddenTriple(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     bool progress = false;
 
@@ -1270,14 +1217,8 @@ bool applyHiddenTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
 
                             if (progress) {
                                 if (solving_mode) {
-                                    FILE *logFile = fopen(log_file, "a");
-                                    if (logFile == NULL) {
-                                        printf("Error opening log file.\n");
-                                        return false; // Exit if the log file cannot be opened
-                                    }
-                                    fprintf(logFile,"Hidden Triple [%d, %d, %d] in cells (%d, %d), (%d, %d) and (%d, %d): cleared other candidates\n", d1, d2, d3, r1+1, c1+1, r2+1, c2+1, r3+1, c3+1);
-                                    fprintf(logFile,"\n");
-                                    fclose(logFile); // Close the file before returning
+                                    log_printf(log,"Hidden Triple [%d, %d, %d] in cells (%d, %d), (%d, %d) and (%d, %d): cleared other candidates\n", d1, d2, d3, r1+1, c1+1, r2+1, c2+1, r3+1, c3+1);
+                                    log_printf(log,"\n");
                                 }
                                 stats->hidden_triple++;
                                 return progress;
@@ -1302,13 +1243,15 @@ bool applyHiddenTriple(Sudoku *sudoku, SolverStats *stats, bool solving_mode, ch
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyPointingTriples(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *log_file) {
+bool applyPointingTriples(Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
 
     bool progress = false;
 
@@ -1399,21 +1342,15 @@ bool applyPointingTriples(Sudoku *sudoku, SolverStats *stats, bool solving_mode,
                                             candidates[r][cc] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile,"Pointing Triple (Outside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, r+1, cc+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log,"Pointing Triple (Outside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, r+1, cc+1);
                                             }
                                         }
                                     }
                                 } 
                                 if (progress) {
-                                    FILE *logFile = fopen(log_file, "a");
-                                    fprintf(logFile,"\n");
-                                    fclose(logFile);
+                                    if (solving_mode) {
+                                        log_printf(log,"\n");
+                                    }
                                     stats->pointing_triple++;
                                     return progress;
                                 }
@@ -1424,21 +1361,15 @@ bool applyPointingTriples(Sudoku *sudoku, SolverStats *stats, bool solving_mode,
                                             candidates[rr][c] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile,"Pointing Triple (Outside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, rr+1, c+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log,"Pointing Triple (Outside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, rr+1, c+1);
                                             }
                                         }
                                     }
                                 }
                                 if (progress) {
-                                    FILE *logFile = fopen(log_file, "a");
-                                    fprintf(logFile,"\n");
-                                    fclose(logFile);
+                                    if (solving_mode) {
+                                        log_printf(log,"\n");
+                                    }
                                     stats->pointing_triple++;
                                     return progress;
                                 }    
@@ -1476,13 +1407,7 @@ bool applyPointingTriples(Sudoku *sudoku, SolverStats *stats, bool solving_mode,
                                             candidates[innerR][innerC] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile,"Pointing Triple (Inside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, innerR+1, innerC+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log,"Pointing Triple (Inside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, innerR+1, innerC+1);
                                             }
                                         }
                                     } else if (c == otherCol1) { // Column-aligned
@@ -1490,22 +1415,16 @@ bool applyPointingTriples(Sudoku *sudoku, SolverStats *stats, bool solving_mode,
                                             candidates[innerR][innerC] &= ~digitMask(d);
                                             progress = true;
                                             if (solving_mode) {
-                                                FILE *logFile = fopen(log_file, "a");
-                                                if (logFile == NULL) {
-                                                    printf("Error opening log file.\n");
-                                                    return false; // Exit if the log file cannot be opened
-                                                }
-                                                fprintf(logFile,"Pointing Triple (Inside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, innerR+1, innerC+1);
-                                                fclose(logFile); // Close the file before returning
+                                                log_printf(log,"Pointing Triple (Inside Box) at cells (%d, %d), (%d, %d) and (%d, %d): removed candidate %d from cell (%d, %d)\n", r+1, c+1, otherRow1+1, otherCol1+1, otherRow2+1, otherCol2+1, d, innerR+1, innerC+1);
                                             }
                                         }
                                     }
                                 }
                             }
                             if (progress) {
-                                FILE *logFile = fopen(log_file, "a");
-                                fprintf(logFile,"\n");
-                                fclose(logFile);
+                                if (solving_mode) {
+                                    log_printf(log,"\n");
+                                }
                                 stats->pointing_triple++;
                                 return progress;
                             }
@@ -1534,12 +1453,13 @@ bool applyPointingTriples(Sudoku *sudoku, SolverStats *stats, bool solving_mode,
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  *
  * Returns:
  * - true if progress is made on the puzzle, false otherwise.
  */
-bool applyXWing(Sudoku *sudoku, SolverStats *stats) {
+bool applyXWing(Sudoku *sudoku, Candidates candidates, SolverStats *stats) {
     bool progress = false;
 
     // Row-based X-Wing
@@ -1699,94 +1619,280 @@ bool validateSudoku(Sudoku *sudoku) {
 }
 
 
+#ifdef SOLVER_COUNTERS
+// Stats receiving the counts of the searches run by the calling thread (see `counters_attach`)
+_Thread_local SolverStats *counted_stats = NULL;
+
+
 /**
- * Function: solve_human
- * ----------------------
+ * Function: countersClock
+ * -----------------------
+ * Returns a monotonic time in seconds, used to time the techniques.
+ */
+static double countersClock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+
+/**
+ * Function: countCandidates
+ * -------------------------
+ * Returns the total number of candidates left in the grid.
+ */
+static long countCandidates(Candidates candidates) {
+    long count = 0;
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            count += bitCount(candidates[r][c]);
+        }
+    }
+    return count;
+}
+
+
+/**
+ * Function: addCounters
+ * ---------------------
+ * Adds to some counters what other counters gained since a snapshot of them.
+ *
+ * Parameters:
+ * - to: The counters to update.
+ * - current: The counters that gained counts.
+ * - initial: Snapshot of `current` taken before.
+ */
+static void addCounters(SearchCounters *to, const SearchCounters *current, const SearchCounters *initial) {
+    to->nodes += current->nodes - initial->nodes;
+    to->backtracks += current->backtracks - initial->backtracks;
+    if (current->max_depth > to->max_depth) to->max_depth = current->max_depth;
+    to->propagations += current->propagations - initial->propagations;
+    to->eliminated += current->eliminated - initial->eliminated;
+    for (int technique = 0; technique < N_TECHNIQUES; technique++) {
+        to->technique_seconds[technique] += current->technique_seconds[technique] - initial->technique_seconds[technique];
+    }
+}
+#endif
+
+
+/**
+ * Function: applyTechnique
+ * ------------------------
+ * Applies one of the techniques of the human solver to the puzzle.
+ *
+ * Parameters:
+ * - technique: The technique to apply.
+ * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - candidates: Candidates of the cells of the puzzle.
+ * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
+ * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - log: Log receiving the moves when solving_mode is set.
+ *
+ * Returns:
+ * - true if progress is made on the puzzle, false otherwise.
+ */
+static bool applyTechnique(Technique technique, Sudoku *sudoku, Candidates candidates, SolverStats *stats, bool solving_mode, SolverLog *log) {
+    switch (technique) {
+        case TECHNIQUE_NAKED_SINGLE:    return applyNakedSingle(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_HIDDEN_SINGLE:   return applyHiddenSingle(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_POINTING_PAIR:   return applyPointingPair(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_NAKED_PAIR:      return applyNakedPair(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_HIDDEN_PAIR:     return applyHiddenPair(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_POINTING_TRIPLE: return applyPointingTriples(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_NAKED_TRIPLE:    return applyNakedTriple(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_HIDDEN_TRIPLE:   return applyHiddenTriple(sudoku, candidates, stats, solving_mode, log);
+        case TECHNIQUE_X_WING:          return applyXWing(sudoku, candidates, stats);
+        default:                        return false;
+    }
+}
+
+
+/**
+ * Function: solveHuman
+ * --------------------
+ * Solves a Sudoku puzzle using human-like strategies: at every round the techniques are tried in order
+ * (simplest first) until one makes progress, until none does.
+ *
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
+ * - log: Log receiving the moves made, or NULL not to record them.
+ * - states: Array receiving the state of the solve at the start of every round, or NULL.
+ * - capacity: Size of `states`; later rounds are not recorded.
+ * - n_states: Pointer receiving the number of states recorded (when `states` is not NULL).
+ *
+ * Returns:
+ * - true if the puzzle is solved, false otherwise.
+ */
+static bool solveHuman(Sudoku *sudoku, SolverStats *stats, SolverLog *log, SolverState *states, int capacity, int *n_states) {
+    bool solving_mode = log != NULL;
+    if (solving_mode && log->buffer != NULL && log->capacity > 0) {
+        log->buffer[log->length] = '\0';
+    }
+
+#ifdef SOLVER_COUNTERS
+    // The solve counts into its own stats, and adds its counts to the ones attached by the caller when it is done
+    SearchCounters initial = stats->counters;
+    SolverStats *outer = counters_attach(stats);
+#endif
+
+    Candidates candidates;
+    initCandidates(sudoku, candidates);
+    bool valid = true;
+    bool progress;
+    do {
+        if (states != NULL && *n_states < capacity) {
+            states[*n_states].sudoku = *sudoku;
+            memcpy(states[*n_states].candidates, candidates, sizeof(Candidates));
+            (*n_states)++;
+        }
+
+        progress = false;
+        for (int technique = 0; technique < N_TECHNIQUES && !progress; technique++) {
+#ifdef SOLVER_COUNTERS
+            double begin = countersClock();
+            long before = countCandidates(candidates);
+            bool applied = applyTechnique(technique, sudoku, candidates, stats, solving_mode, log);
+            stats->counters.technique_seconds[technique] += countersClock() - begin;
+            stats->counters.eliminated += before - countCandidates(candidates);
+#else
+            bool applied = applyTechnique(technique, sudoku, candidates, stats, solving_mode, log);
+#endif
+            if (applied) {
+                if (!validateSudoku(sudoku)) {
+                    // printf("Error: Invalid state after applying %s.\n", technique_name(technique));
+                    valid = false;
+                    break;
+                }
+                progress = true;
+            }
+        }
+    } while (progress && valid);
+
+    bool solved = valid && !find_empty(sudoku, &(int){0}, &(int){0});
+#ifdef SOLVER_COUNTERS
+    counters_attach(outer);
+    if (outer != NULL && outer != stats) {
+        addCounters(&outer->counters, &stats->counters, &initial);
+    }
+#endif
+    return solved;
+}
+
+
+/**
+ * Function: solve_human_log
+ * -------------------------
  * Solves a Sudoku puzzle using human-like strategies. Applies techniques
  * iteratively until no more progress can be made.
  *
  * Parameters:
  * - sudoku: Pointer to the Sudoku puzzle structure.
  * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
+ * - log: Log receiving the moves made, or NULL not to record them.
+ *
+ * Returns:
+ * - true if the puzzle is solved, false otherwise.
+ */
+bool solve_human_log(Sudoku *sudoku, SolverStats *stats, SolverLog *log) {
+    TRACE_SCOPE("solve_human");
+    return solveHuman(sudoku, stats, log, NULL, 0, NULL);
+}
+
+
+/**
+ * Function: record_states
+ * -----------------------
+ * Solves a Sudoku puzzle like `solve_human_log` and records the state of the solve (grid and candidates)
+ * at the start of every round, so that the techniques can be benchmarked on realistic mid-solve states.
+ *
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - states: Array receiving the states.
+ * - capacity: Size of `states`; later rounds are not recorded.
+ *
+ * Returns:
+ * - The number of states recorded.
+ */
+int record_states(Sudoku *sudoku, SolverState *states, int capacity) {
+    SolverStats stats = {0};
+    int n_states = 0;
+    solveHuman(sudoku, &stats, NULL, states, capacity, &n_states);
+    return n_states;
+}
+
+
+/**
+ * Function: apply_technique
+ * -------------------------
+ * Applies a single technique to a recorded state, without logging the moves.
+ *
+ * Parameters:
+ * - technique: The technique to apply.
+ * - state: Pointer to the SolverState structure, updated in place.
+ * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
+ *
+ * Returns:
+ * - true if the technique made progress, false otherwise.
+ */
+bool apply_technique(Technique technique, SolverState *state, SolverStats *stats) {
+    return applyTechnique(technique, &state->sudoku, state->candidates, stats, false, NULL);
+}
+
+
+/**
+ * Function: technique_name
+ * ------------------------
+ * Returns the name of a technique, as used for the fields of SolverStats (e.g. "naked_single").
+ */
+const char *technique_name(Technique technique) {
+    static const char *names[N_TECHNIQUES] = {
+        "naked_single", "hidden_single", "pointing_pair", "naked_pair", "hidden_pair",
+        "pointing_triple", "naked_triple", "hidden_triple", "x_wing"
+    };
+    return (technique >= 0 && technique < N_TECHNIQUES) ? names[technique] : "unknown";
+}
+
+
+/**
+ * Function: solve_human
+ * ----------------------
+ * Solves a Sudoku puzzle with `solve_human_log`, recording the moves made in the file
+ * `solver-actions.log` of the output folder.
+ *
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku puzzle structure.
+ * - stats: Pointer to the SolverStats structure for tracking the use of techniques.
  * - solving_mode: boolean flag indicating whether to record the moves made in a log file.
+ * - output_path: Path to the folder containing the log file.
  *
  * Returns:
  * - true if the puzzle is solved, false otherwise.
  */
 bool solve_human(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *output_path) {
+    if (!solving_mode) {
+        return solve_human_log(sudoku, stats, NULL);
+    }
 
-    // Clear the log file at the beginning of the function
+    // Clear the log file at the beginning of the solve, and keep it open until the end
     char log_file[256];
     sprintf(log_file, "%s" PATH_SEPARATOR "solver-actions.log", output_path);
-    FILE *logFile = fopen(log_file, "w");
-    if (logFile == NULL) {
+    SolverLog log = {0};
+    log.file = fopen(log_file, "w");
+    if (log.file == NULL) {
         // printf("Error opening log file for clearing.\n");
         return false; // Exit if the log file cannot be opened
     }
-    fclose(logFile); // Close immediately after clearing
-
-    initCandidates(sudoku);
-    bool progress;
-    do {
-        progress = false;
-        if (applyNakedSingle(sudoku, stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Naked Single.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyHiddenSingle(sudoku, stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Hidden Single.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyPointingPair(sudoku,stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Pointing Pair.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyNakedPair(sudoku, stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Naked Pair.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyHiddenPair(sudoku, stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Hidden Pair.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyPointingTriples(sudoku,stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Pointing Triple.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyNakedTriple(sudoku, stats, solving_mode, log_file)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Naked Triple.\n");
-                return false;
-            }
-            progress = true;
-        } else if (applyHiddenTriple(sudoku, stats, solving_mode, log_file)){
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying Hidden Triple.\n");
-                return false;
-            }
-            progress = true;
-        }  else if (applyXWing(sudoku, stats)) {
-            if (!validateSudoku(sudoku)) {
-                // printf("Error: Invalid state after applying X-Wing.\n");
-                return false;
-            }
-            progress = true;
-        }
-    } while (progress);
-
-    return !find_empty(sudoku, &(int){0}, &(int){0});
+    bool solved = solve_human_log(sudoku, stats, &log);
+    fclose(log.file);
+    return solved;
 }
 
 
@@ -1812,6 +1918,60 @@ void print_stats(SolverStats *stats) {
     printf("hidden triple: %d\n", stats->hidden_triple);
     printf("pointing triple: %d\n", stats->pointing_triple);
     printf("X wing: %d\n", stats->x_wing);
+    print_counters(stdout, stats);
+}
+
+
+/**
+ * Function: counters_attach
+ * -------------------------
+ * Makes the searches run by the calling thread (backtracking, solution counting, human solves) add their
+ * instrumentation counters to the given stats, until another one is attached. Does nothing unless the program
+ * is compiled with -DSOLVER_COUNTERS.
+ *
+ * Parameters:
+ * - stats: Pointer to the SolverStats structure receiving the counts, or NULL to stop counting.
+ *
+ * Returns:
+ * - The stats attached before, so that callers can restore them.
+ */
+SolverStats *counters_attach(SolverStats *stats) {
+#ifdef SOLVER_COUNTERS
+    SolverStats *previous = counted_stats;
+    counted_stats = stats;
+    return previous;
+#else
+    (void)stats;
+    return NULL;
+#endif
+}
+
+
+/**
+ * Function: print_counters
+ * ------------------------
+ * Prints the instrumentation counters of the stats. Prints nothing unless the program is compiled
+ * with -DSOLVER_COUNTERS.
+ *
+ * Parameters:
+ * - file: Destination of the counters.
+ * - stats: Pointer to the SolverStats structure containing the counters.
+ */
+void print_counters(FILE *file, const SolverStats *stats) {
+#ifdef SOLVER_COUNTERS
+    const SearchCounters *counters = &stats->counters;
+    fprintf(file, "nodes: %ld\n", counters->nodes);
+    fprintf(file, "backtracks: %ld\n", counters->backtracks);
+    fprintf(file, "max depth: %d\n", counters->max_depth);
+    fprintf(file, "propagations: %ld\n", counters->propagations);
+    fprintf(file, "eliminated: %ld\n", counters->eliminated);
+    for (int technique = 0; technique < N_TECHNIQUES; technique++) {
+        fprintf(file, "%s time: %.3f ms\n", technique_name(technique), counters->technique_seconds[technique] * 1e3);
+    }
+#else
+    (void)file;
+    (void)stats;
+#endif
 }
 
 
@@ -4,6 +4,51 @@
 
 #include "io.h" // Include the file where the Sudoku struct is defined
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Type: Technique
+ * ---------------
+ * Techniques of the human solver, in the order in which they are tried at every round.
+ */
+typedef enum {
+    TECHNIQUE_NAKED_SINGLE,
+    TECHNIQUE_HIDDEN_SINGLE,
+    TECHNIQUE_POINTING_PAIR,
+    TECHNIQUE_NAKED_PAIR,
+    TECHNIQUE_HIDDEN_PAIR,
+    TECHNIQUE_POINTING_TRIPLE,
+    TECHNIQUE_NAKED_TRIPLE,
+    TECHNIQUE_HIDDEN_TRIPLE,
+    TECHNIQUE_X_WING,
+    N_TECHNIQUES
+} Technique;
+
+#ifdef SOLVER_COUNTERS
+/**
+ * Struct: SearchCounters
+ * ----------------------
+ * Instrumentation of the solvers, compiled in with -DSOLVER_COUNTERS (`make COUNTERS=1`).
+ *
+ * Fields:
+ * - nodes: Number of nodes visited by the backtracking and counting searches.
+ * - backtracks: Number of guesses undone by the searches.
+ * - max_depth: Maximum depth reached by the searches.
+ * - propagations: Number of placed digits propagated to the candidates of their peers.
+ * - eliminated: Number of candidates eliminated by the human solver.
+ * - technique_seconds: Wall time spent in each technique of the human solver.
+ */
+typedef struct {
+    long nodes;
+    long backtracks;
+    int max_depth;
+    long propagations;
+    long eliminated;
+    double technique_seconds[N_TECHNIQUES];
+} SearchCounters;
+#endif
+
 /**
  * Struct: SolverStats
  * --------------------
@@ -20,6 +65,7 @@
  * - hidden_triple: Count of times the hidden triple technique is used.
  * - pointing_triple: Count of times the pointing triple technique is used.
  * - x_wing: Count of times the X-Wing technique is used.
+ * - counters: Instrumentation counters, only with -DSOLVER_COUNTERS.
  */
 typedef struct {
     int naked_single;
@@ -31,11 +77,79 @@ typedef struct {
     int hidden_triple;
     int pointing_triple;
     int x_wing;
+#ifdef SOLVER_COUNTERS
+    SearchCounters counters;
+#endif
 } SolverStats;
 
+/**
+ * Struct: SolverLog
+ * -----------------
+ * Destination of the moves recorded by the human solver.
+ *
+ * Fields:
+ * - file: Open file receiving the moves, or NULL.
+ * - buffer: Caller-provided buffer receiving the moves (always NUL-terminated), or NULL.
+ * - capacity: Size of `buffer` in bytes.
+ * - length: Number of bytes written to `buffer` so far.
+ */
+typedef struct {
+    FILE *file;
+    char *buffer;
+    size_t capacity;
+    size_t length;
+} SolverLog;
+
+
+/**
+ * Struct: SolverState
+ * -------------------
+ * State of a human solve between two rounds: the grid and the candidates of its cells (as digit bitmasks).
+ */
+typedef struct {
+    Sudoku sudoku;
+    unsigned short candidates[N][N];
+} SolverState;
+
+
+bool solve_human_log(Sudoku *sudoku, SolverStats *stats, SolverLog *log);
 
 bool solve_human(Sudoku *sudoku, SolverStats *stats, bool solving_mode, char *output_path);
 
+int record_states(Sudoku *sudoku, SolverState *states, int capacity);
+
+bool apply_technique(Technique technique, SolverState *state, SolverStats *stats);
+
+const char *technique_name(Technique technique);
+
 void print_stats(SolverStats *stats);
 
+SolverStats *counters_attach(SolverStats *stats);
+
+void print_counters(FILE *file, const SolverStats *stats);
+
+#ifdef SOLVER_COUNTERS
+extern _Thread_local SolverStats *counted_stats;
+
+// Depth starts at 1 for the root of a search
+static inline void count_node(int depth) {
+    if (counted_stats != NULL) {
+        counted_stats->counters.nodes++;
+        if (depth > counted_stats->counters.max_depth) counted_stats->counters.max_depth = depth;
+    }
+}
+
+static inline void count_backtrack(void) {
+    if (counted_stats != NULL) counted_stats->counters.backtracks++;
+}
+
+static inline void count_propagation(void) {
+    if (counted_stats != NULL) counted_stats->counters.propagations++;
+}
+#else
+#define count_node(depth) ((void)0)
+#define count_backtrack() ((void)0)
+#define count_propagation() ((void)0)
+#endif
+
 #endif // HUMAN_SOLVER_H
@@ -0,0 +1,268 @@
+#include "store.h"
+#include "canon.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_STORE_LEVEL 4
+#define INITIAL_CAPACITY 1024
+
+
+/******************************************************************************
+ * Puzzle Store
+ * Every puzzle ever emitted is appended to a text file, one record per line:
+ *
+ *     <canonical form, 81 digits> <level> <naked single> <hidden single>
+ *     <naked pair> <hidden pair> <pointing pair> <naked triple>
+ *     <hidden triple> <pointing triple> <x-wing>
+ *
+ * The file is never rewritten. In memory, each record is only an 8-byte
+ * fingerprint of its canonical form, kept in an open-addressing table
+ * (linear probing, at most 3/4 full), so a lookup costs O(1) and an entry
+ * 8–21 bytes. Two different puzzles share a fingerprint with probability
+ * about n^2 / 2^65, i.e. below 1e-5 for ten million puzzles.
+ ******************************************************************************/
+
+
+struct PuzzleStore {
+    FILE *file;
+
+    // Fingerprints of the canonical forms, 0 marks an empty slot
+    uint64_t *slots;
+    long capacity;
+    long count;
+    long level_counts[MAX_STORE_LEVEL + 1];
+
+    pthread_mutex_t lock;
+};
+
+
+/**
+ * Function: fingerprint
+ * ---------------------
+ * 64-bit hash of the 81 cells of a canonical form (never 0).
+ */
+static uint64_t fingerprint(const Sudoku *canonical) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(int i = 0; i < N; i++) {
+        for(int j = 0; j < N; j++) {
+            hash = (hash ^ (uint64_t)canonical->table[i][j]) * 0x100000001b3ULL;
+        }
+    }
+
+    // Final mix, so that the low bits used by the table depend on every cell
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash ? hash : 1;
+}
+
+
+/**
+ * Function: find_slot
+ * -------------------
+ * Returns the slot holding a fingerprint, or the empty slot where it belongs.
+ */
+static long find_slot(const PuzzleStore *store, uint64_t key) {
+    long slot = key & (store->capacity - 1);
+    while(store->slots[slot] != 0 && store->slots[slot] != key) {
+        slot = (slot + 1) & (store->capacity - 1);
+    }
+    return slot;
+}
+
+
+/**
+ * Function: insert_key
+ * --------------------
+ * Inserts a fingerprint into the table, doubling it when it gets 3/4 full.
+ *
+ * Returns:
+ * - 1 if the key was inserted, 0 if it was already present, -1 if the table could not grow.
+ */
+static int insert_key(PuzzleStore *store, uint64_t key) {
+    if(4 * (store->count + 1) > 3 * store->capacity) {
+        uint64_t *old_slots = store->slots;
+        long old_capacity = store->capacity;
+        uint64_t *slots = calloc(2 * old_capacity, sizeof(uint64_t));
+        if(slots == NULL) {
+            return -1;
+        }
+        store->slots = slots;
+        store->capacity = 2 * old_capacity;
+        for(long i = 0; i < old_capacity; i++) {
+            if(old_slots[i] != 0) {
+                store->slots[find_slot(store, old_slots[i])] = old_slots[i];
+            }
+        }
+        free(old_slots);
+    }
+
+    long slot = find_slot(store, key);
+    if(store->slots[slot] == key) {
+        return 0;
+    }
+    store->slots[slot] = key;
+    store->count++;
+    return 1;
+}
+
+
+/**
+ * Function: store_open
+ * --------------------
+ * Opens a puzzle store, indexing the records already in the file (created if missing).
+ * Lines that are not valid records are ignored.
+ *
+ * Parameters:
+ * - path: Path to the store file.
+ *
+ * Returns:
+ * - Pointer to the store, or NULL if the file could not be opened or indexed.
+ */
+PuzzleStore *store_open(const char *path) {
+    PuzzleStore *store = calloc(1, sizeof(PuzzleStore));
+    if(store == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&store->lock, NULL);
+    store->capacity = INITIAL_CAPACITY;
+    store->slots = calloc(store->capacity, sizeof(uint64_t));
+    store->file = fopen(path, "a+");
+    if(store->slots == NULL || store->file == NULL) {
+        store_close(store);
+        return NULL;
+    }
+
+    // Index the existing records
+    char line[256];
+    Sudoku canonical;
+    rewind(store->file);
+    while(fgets(line, sizeof(line), store->file) != NULL) {
+        int i = 0;
+        while(i < N * N && line[i] >= '0' && line[i] <= '9') {
+            canonical.table[i / N][i % N] = line[i] - '0';
+            i++;
+        }
+        if(i != N * N) continue;
+
+        int level = atoi(line + N * N);
+        if(insert_key(store, fingerprint(&canonical)) < 0) {
+            store_close(store);
+            return NULL;
+        }
+        if(level >= 1 && level <= MAX_STORE_LEVEL) {
+            store->level_counts[level]++;
+        }
+    }
+    fseek(store->file, 0, SEEK_END);
+    return store;
+}
+
+
+/**
+ * Function: store_contains
+ * ------------------------
+ * Checks whether a puzzle, or any puzzle equivalent to it, is already in the store.
+ *
+ * Parameters:
+ * - store: Pointer to the PuzzleStore structure.
+ * - puzzle: Pointer to the puzzle to look up.
+ */
+bool store_contains(PuzzleStore *store, const Sudoku *puzzle) {
+    Sudoku canonical;
+    canonicalize(puzzle, &canonical);
+    uint64_t key = fingerprint(&canonical);
+
+    pthread_mutex_lock(&store->lock);
+    bool found = store->slots[find_slot(store, key)] == key;
+    pthread_mutex_unlock(&store->lock);
+    return found;
+}
+
+
+/**
+ * Function: store_add
+ * -------------------
+ * Adds a puzzle to the store unless an equivalent puzzle is already there.
+ * The check and the insertion are atomic, so several threads can share the store.
+ *
+ * Parameters:
+ * - store: Pointer to the PuzzleStore structure.
+ * - puzzle: Pointer to the puzzle to add.
+ * - level: Assessed level of the puzzle.
+ * - stats: Techniques used by the human solver on the puzzle.
+ *
+ * Returns:
+ * - true if the puzzle was new and has been recorded, false if it was a duplicate (or could not be indexed).
+ */
+bool store_add(
+    PuzzleStore *store,
+    const Sudoku *puzzle,
+    int level,
+    const SolverStats *stats
+) {
+    Sudoku canonical;
+    canonicalize(puzzle, &canonical);
+    uint64_t key = fingerprint(&canonical);
+
+    char line[256];
+    int pos = 0;
+    for(int i = 0; i < N; i++) {
+        for(int j = 0; j < N; j++) {
+            line[pos++] = '0' + canonical.table[i][j];
+        }
+    }
+    sprintf(line + pos, " %d %d %d %d %d %d %d %d %d %d\n", level,
+        stats->naked_single, stats->hidden_single,
+        stats->naked_pair, stats->hidden_pair, stats->pointing_pair,
+        stats->naked_triple, stats->hidden_triple, stats->pointing_triple,
+        stats->x_wing);
+
+    pthread_mutex_lock(&store->lock);
+    bool added = insert_key(store, key) == 1;
+    if(added) {
+        fputs(line, store->file);
+        fflush(store->file);
+        if(level >= 1 && level <= MAX_STORE_LEVEL) {
+            store->level_counts[level]++;
+        }
+    }
+    pthread_mutex_unlock(&store->lock);
+    return added;
+}
+
+
+/**
+ * Function: store_count
+ * ---------------------
+ * Returns the number of puzzles of a level in the store, or of all levels when `level` is 0.
+ */
+long store_count(PuzzleStore *store, int level) {
+    pthread_mutex_lock(&store->lock);
+    long count = store->count;
+    if(level >= 1 && level <= MAX_STORE_LEVEL) {
+        count = store->level_counts[level];
+    }
+    pthread_mutex_unlock(&store->lock);
+    return count;
+}
+
+
+/**
+ * Function: store_close
+ * ---------------------
+ * Closes the store file and frees the index (NULL is ignored).
+ */
+void store_close(PuzzleStore *store) {
+    if(store == NULL) return;
+
+    if(store->file != NULL) {
+        fclose(store->file);
+    }
+    pthread_mutex_destroy(&store->lock);
+    free(store->slots);
+    free(store);
+}
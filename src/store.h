@@ -0,0 +1,20 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include "io.h"
+#include "solver_human.h"
+#include <stdbool.h>
+
+typedef struct PuzzleStore PuzzleStore;
+
+PuzzleStore *store_open(const char *path);
+
+bool store_contains(PuzzleStore *store, const Sudoku *puzzle);
+
+bool store_add(PuzzleStore *store, const Sudoku *puzzle, int level, const SolverStats *stats);
+
+long store_count(PuzzleStore *store, int level);
+
+void store_close(PuzzleStore *store);
+
+#endif
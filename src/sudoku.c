@@ -0,0 +1,247 @@
+#include "sudoku.h"
+#include "generator.h"
+#include "io.h"
+#include "rng.h"
+#include "solver_human.h"
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- HELPER FUNCTIONS --- //
+
+
+/**
+ * Function: parse_puzzle
+ * ----------------------
+ * Reads a puzzle in the 81-character format and checks that its givens do not conflict.
+ *
+ * Parameters:
+ * - text: The 81 characters of the puzzle (anything may follow them).
+ * - sudoku: Pointer to the Sudoku grid receiving the puzzle.
+ *
+ * Returns:
+ * - 0 on success, SUDOKU_ERROR_FORMAT or SUDOKU_ERROR_CONFLICT otherwise.
+ */
+static int parse_puzzle(const char *text, Sudoku *sudoku) {
+    if(text == NULL) {
+        return SUDOKU_ERROR_FORMAT;
+    }
+
+    unsigned short masks[3][N] = {{0}};
+    for(int i = 0; i < N * N; i++) {
+        int r = i / N, c = i % N;
+        if(text[i] == '.' || text[i] == '0') {
+            sudoku->table[r][c] = 0;
+            continue;
+        }
+        if(text[i] < '1' || text[i] > '9') {
+            return SUDOKU_ERROR_FORMAT;
+        }
+        int digit = text[i] - '0';
+        unsigned short bit = 1U << (digit - 1);
+        if((masks[0][r] | masks[1][c] | masks[2][(r/3)*3 + c/3]) & bit) {
+            return SUDOKU_ERROR_CONFLICT;
+        }
+        masks[0][r] |= bit;
+        masks[1][c] |= bit;
+        masks[2][(r/3)*3 + c/3] |= bit;
+        sudoku->table[r][c] = digit;
+    }
+    return 0;
+}
+
+
+/**
+ * Function: format_puzzle
+ * -----------------------
+ * Writes the 81 digits of a puzzle, without a terminator.
+ */
+static void format_puzzle(const Sudoku *sudoku, char *text) {
+    for(int i = 0; i < N * N; i++) {
+        text[i] = '0' + sudoku->table[i / N][i % N];
+    }
+}
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- API --- //
+
+
+/**
+ * Function: sudoku_strerror
+ * -------------------------
+ * Returns a description of an error code.
+ */
+const char *sudoku_strerror(int code) {
+    switch(code) {
+        case SUDOKU_ERROR_FORMAT: return "puzzle must be 81 characters among 0-9 and '.'";
+        case SUDOKU_ERROR_CONFLICT: return "conflicting givens";
+        case SUDOKU_ERROR_UNSOLVABLE: return "not solvable with the human techniques";
+        case SUDOKU_ERROR_ARGUMENT: return "invalid argument";
+        case SUDOKU_ERROR_GENERATION: return "no puzzle of the level found";
+        default: return (code >= 0) ? "success" : "unknown error";
+    }
+}
+
+
+/**
+ * Function: sudoku_solve
+ * ----------------------
+ * Finds the solutions of a puzzle, up to `max_solutions` (at most SUDOKU_MAX_SOLUTIONS).
+ *
+ * Parameters:
+ * - puzzle: The puzzle.
+ * - solutions: Buffer receiving the solutions, 81 characters each, one after the other (no terminators).
+ * - max_solutions: Number of solutions the buffer can hold.
+ *
+ * Returns:
+ * - The number of solutions written, or an error code.
+ */
+int sudoku_solve(const char *puzzle, char *solutions, int max_solutions) {
+    Sudoku sudoku;
+    Sudoku found[N_SOL];
+    int error = parse_puzzle(puzzle, &sudoku);
+    if(error < 0) {
+        return error;
+    }
+    if(solutions == NULL || max_solutions < 0) {
+        return SUDOKU_ERROR_ARGUMENT;
+    }
+
+    int n_solutions = find_solutions(&sudoku, found, time(NULL));
+    if(n_solutions > max_solutions) {
+        n_solutions = max_solutions;
+    }
+    for(int k = 0; k < n_solutions; k++) {
+        format_puzzle(&found[k], solutions + k * SUDOKU_CELLS);
+    }
+    return n_solutions;
+}
+
+
+/**
+ * Function: sudoku_count_solutions
+ * --------------------------------
+ * Counts the solutions of a puzzle, stopping at SUDOKU_MAX_SOLUTIONS.
+ *
+ * Returns:
+ * - The number of solutions (SUDOKU_MAX_SOLUTIONS means that many or more), or an error code.
+ */
+int sudoku_count_solutions(const char *puzzle) {
+    Sudoku sudoku;
+    int error = parse_puzzle(puzzle, &sudoku);
+    if(error < 0) {
+        return error;
+    }
+    return count_solutions(&sudoku, time(NULL));
+}
+
+
+/**
+ * Function: sudoku_rate
+ * ---------------------
+ * Rates a puzzle with the human solver.
+ *
+ * Parameters:
+ * - puzzle: The puzzle.
+ * - techniques: Array receiving how many times each technique was used, in the order of SolverStats
+ *   (naked single, hidden single, naked pair, hidden pair, pointing pair, naked triple, hidden triple,
+ *   pointing triple, X-Wing), or NULL.
+ *
+ * Returns:
+ * - The level of the puzzle (1–4), or an error code.
+ */
+int sudoku_rate(const char *puzzle, int techniques[SUDOKU_TECHNIQUES]) {
+    Sudoku sudoku;
+    SolverStats stats = {0};
+    int error = parse_puzzle(puzzle, &sudoku);
+    if(error < 0) {
+        return error;
+    }
+    if(!solve_human_log(&sudoku, &stats, NULL)) {
+        return SUDOKU_ERROR_UNSOLVABLE;
+    }
+
+    if(techniques != NULL) {
+        int counts[SUDOKU_TECHNIQUES] = {
+            stats.naked_single, stats.hidden_single,
+            stats.naked_pair, stats.hidden_pair, stats.pointing_pair,
+            stats.naked_triple, stats.hidden_triple, stats.pointing_triple,
+            stats.x_wing
+        };
+        memcpy(techniques, counts, sizeof(counts));
+    }
+    return stats_level(&stats);
+}
+
+
+/**
+ * Function: sudoku_generate
+ * -------------------------
+ * Generates a puzzle of the desired level. The same seed always gives the same puzzle.
+ * Levels 3–4 are searched from scratch, since the seed puzzles live on disk.
+ *
+ * Parameters:
+ * - level: Desired difficulty level (1–4).
+ * - seed: Seed of the random generator.
+ * - puzzle: Buffer of at least SUDOKU_CELLS + 1 characters receiving the puzzle (NUL-terminated).
+ *
+ * Returns:
+ * - The level of the puzzle, or an error code.
+ */
+int sudoku_generate(int level, uint64_t seed, char *puzzle) {
+    if(level < 1 || level > 4 || puzzle == NULL) {
+        return SUDOKU_ERROR_ARGUMENT;
+    }
+
+    Sudoku sudoku;
+    Rng rng;
+    rng_seed(&rng, seed);
+    if(!generate_puzzle(&sudoku, level, NULL, NULL, false, NULL, 1, &rng)) {
+        return SUDOKU_ERROR_GENERATION;
+    }
+    format_puzzle(&sudoku, puzzle);
+    puzzle[SUDOKU_CELLS] = '\0';
+    return level;
+}
+
+
+/**
+ * Function: sudoku_hint
+ * ---------------------
+ * Describes the next move the human solver would make on a puzzle.
+ * Moves made of several eliminations are described on several lines.
+ *
+ * Parameters:
+ * - puzzle: The puzzle.
+ * - hint: Buffer receiving the description (NUL-terminated, truncated if needed).
+ * - size: Size of the buffer.
+ *
+ * Returns:
+ * - The length of the description, or an error code.
+ */
+int sudoku_hint(const char *puzzle, char *hint, size_t size) {
+    Sudoku sudoku;
+    SolverStats stats = {0};
+    int error = parse_puzzle(puzzle, &sudoku);
+    if(error < 0) {
+        return error;
+    }
+    if(hint == NULL || size == 0) {
+        return SUDOKU_ERROR_ARGUMENT;
+    }
+
+    // The first move is the first block of the log, up to the empty line closing it
+    SolverLog log = {.buffer = hint, .capacity = size};
+    solve_human_log(&sudoku, &stats, &log);
+    char *end = strstr(hint, "\n\n");
+    if(end != NULL) {
+        end[1] = '\0';
+    }
+    if(hint[0] == '\0') {
+        return SUDOKU_ERROR_UNSOLVABLE;
+    }
+    return (int)strlen(hint);
+}
@@ -0,0 +1,37 @@
+#ifndef SUDOKU_H
+#define SUDOKU_H
+
+/**
+ * C API of libsudoku.
+ * Puzzles are passed as 81 characters, row by row, with '0' or '.' for the empty cells.
+ * Every function works on caller-provided buffers only: there is no global state and no file I/O,
+ * so the functions can be called from several threads at once.
+ * Functions return a non-negative value on success and one of the SUDOKU_ERROR codes otherwise.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SUDOKU_CELLS 81
+#define SUDOKU_MAX_SOLUTIONS 5
+#define SUDOKU_TECHNIQUES 9
+
+#define SUDOKU_ERROR_FORMAT -1
+#define SUDOKU_ERROR_CONFLICT -2
+#define SUDOKU_ERROR_UNSOLVABLE -3
+#define SUDOKU_ERROR_ARGUMENT -4
+#define SUDOKU_ERROR_GENERATION -5
+
+const char *sudoku_strerror(int code);
+
+int sudoku_solve(const char *puzzle, char *solutions, int max_solutions);
+
+int sudoku_count_solutions(const char *puzzle);
+
+int sudoku_rate(const char *puzzle, int techniques[SUDOKU_TECHNIQUES]);
+
+int sudoku_generate(int level, uint64_t seed, char *puzzle);
+
+int sudoku_hint(const char *puzzle, char *hint, size_t size);
+
+#endif
@@ -0,0 +1,353 @@
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define MAX_THREADS 64
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- THREAD POOL --- //
+
+
+typedef struct {
+    TaskFunction function;
+    void *arg;
+} Task;
+
+// Circular queue of tasks owned by one worker, grown on demand
+typedef struct {
+    Task *tasks;
+    int capacity;
+    int head;
+    int count;
+    pthread_mutex_t lock;
+} TaskDeque;
+
+struct ThreadPool {
+    pthread_t threads[MAX_THREADS];
+    int n_threads;
+    int n_started;
+
+    // One queue per worker: each worker serves its own queue and steals from the others when it is empty
+    TaskDeque deques[MAX_THREADS];
+    atomic_uint next_deque;
+
+    // Number of tasks sitting in the queues, and of submitted tasks that have not completed yet
+    atomic_int queued;
+    atomic_int pending;
+    bool shutdown;
+
+    pthread_mutex_t lock;
+    pthread_cond_t task_available;
+    pthread_cond_t all_done;
+};
+
+// Pool and queue index of the calling thread, when it is a worker
+static _Thread_local ThreadPool *current_pool = NULL;
+static _Thread_local int current_worker = -1;
+
+typedef struct {
+    ThreadPool *pool;
+    int id;
+} WorkerArg;
+
+
+/**
+ * Function: deque_push
+ * --------------------
+ * Appends a task to a queue, growing it if needed.
+ *
+ * Parameters:
+ * - deque: Pointer to the TaskDeque structure.
+ * - task: The task to append.
+ */
+static void deque_push(TaskDeque *deque, Task task) {
+    pthread_mutex_lock(&deque->lock);
+
+    // Grow the queue, unrolling the circular buffer into the new one
+    if (deque->count == deque->capacity) {
+        Task *tasks = malloc(2 * deque->capacity * sizeof(Task));
+        if (tasks == NULL) {
+            printf("Error allocating the task queue\n");
+            exit(1);
+        }
+        for (int i = 0; i < deque->count; i++) {
+            tasks[i] = deque->tasks[(deque->head + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity *= 2;
+        deque->head = 0;
+    }
+
+    deque->tasks[(deque->head + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+
+/**
+ * Function: deque_pop
+ * -------------------
+ * Removes the oldest task of a queue. The owner and the thieves both take the oldest task, which keeps
+ * completion close to submission order for callers that consume results in order.
+ *
+ * Parameters:
+ * - deque: Pointer to the TaskDeque structure.
+ * - task: Pointer receiving the task.
+ *
+ * Returns:
+ * - true if a task was removed,
+ *   false if the queue was empty.
+ */
+static bool deque_pop(TaskDeque *deque, Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == 0) {
+        pthread_mutex_unlock(&deque->lock);
+        return false;
+    }
+    *task = deque->tasks[deque->head];
+    deque->head = (deque->head + 1) % deque->capacity;
+    deque->count--;
+    pthread_mutex_unlock(&deque->lock);
+    return true;
+}
+
+
+/**
+ * Function: find_task
+ * -------------------
+ * Takes a task from the worker's own queue, or steals one from the other workers, starting from its neighbour.
+ *
+ * Parameters:
+ * - pool: Pointer to the ThreadPool structure.
+ * - id: Index of the worker.
+ * - task: Pointer receiving the task.
+ *
+ * Returns:
+ * - true if a task was found,
+ *   false otherwise.
+ */
+static bool find_task(ThreadPool *pool, int id, Task *task) {
+    for (int i = 0; i < pool->n_threads; i++) {
+        if (deque_pop(&pool->deques[(id + i) % pool->n_threads], task)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Function: worker_loop
+ * ---------------------
+ * Body of each worker thread: repeatedly takes a task (see `find_task`) and runs it,
+ * sleeping while there is none, until the pool is shut down and every queue is empty.
+ *
+ * Parameters:
+ * - arg: Pointer to the WorkerArg structure, freed by the worker.
+ */
+static void *worker_loop(void *arg) {
+    ThreadPool *pool = ((WorkerArg *)arg)->pool;
+    int id = ((WorkerArg *)arg)->id;
+    free(arg);
+    current_pool = pool;
+    current_worker = id;
+
+    while (true) {
+        Task task;
+        if (find_task(pool, id, &task)) {
+            task.function(task.arg);
+
+            if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+                pthread_mutex_lock(&pool->lock);
+                pthread_cond_broadcast(&pool->all_done);
+                pthread_mutex_unlock(&pool->lock);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->queued) <= 0 && !pool->shutdown) {
+            pthread_cond_wait(&pool->task_available, &pool->lock);
+        }
+        if (atomic_load(&pool->queued) <= 0 && pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+
+/**
+ * Function: thread_pool_default_size
+ * ----------------------------------
+ * Returns the number of online processors, used as the default number of workers.
+ *
+ * Returns:
+ * - The number of processors (at least 1, at most MAX_THREADS).
+ */
+int thread_pool_default_size(void) {
+    long n_cores;
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    n_cores = info.dwNumberOfProcessors;
+#else
+    n_cores = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n_cores < 1) return 1;
+    if (n_cores > MAX_THREADS) return MAX_THREADS;
+    return (int)n_cores;
+}
+
+
+/**
+ * Function: thread_pool_create
+ * ----------------------------
+ * Creates a pool of worker threads waiting for tasks.
+ *
+ * Parameters:
+ * - n_threads: Number of workers (clamped to 1–MAX_THREADS).
+ *
+ * Returns:
+ * - Pointer to the new pool, or NULL if it could not be created.
+ */
+ThreadPool *thread_pool_create(int n_threads) {
+    if (n_threads < 1) n_threads = 1;
+    if (n_threads > MAX_THREADS) n_threads = MAX_THREADS;
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < n_threads; i++) {
+        TaskDeque *deque = &pool->deques[i];
+        deque->capacity = 64;
+        deque->tasks = malloc(deque->capacity * sizeof(Task));
+        if (deque->tasks == NULL) {
+            for (int j = 0; j < i; j++) {
+                free(pool->deques[j].tasks);
+                pthread_mutex_destroy(&pool->deques[j].lock);
+            }
+            free(pool);
+            return NULL;
+        }
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->task_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    // Workers are only started once every queue exists, since they scan all of them.
+    // If some fail to start, their queues are still served by the others through stealing.
+    pool->n_threads = n_threads;
+    for (int i = 0; i < n_threads; i++) {
+        WorkerArg *arg = malloc(sizeof(WorkerArg));
+        if (arg == NULL) {
+            break;
+        }
+        arg->pool = pool;
+        arg->id = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_loop, arg) != 0) {
+            free(arg);
+            break;
+        }
+        pool->n_started++;
+    }
+    if (pool->n_started == 0) {
+        thread_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+
+/**
+ * Function: thread_pool_submit
+ * ----------------------------
+ * Queues a task to be executed by one of the workers.
+ * Tasks submitted by a worker go to its own queue, the others are spread round-robin over the queues;
+ * idle workers steal from the busy ones, so a few slow tasks never leave the other workers waiting.
+ *
+ * Parameters:
+ * - pool: Pointer to the ThreadPool structure.
+ * - function: Function to be executed.
+ * - arg: Argument passed to the function.
+ */
+void thread_pool_submit(
+    ThreadPool *pool,
+    TaskFunction function,
+    void *arg
+) {
+    Task task = { function, arg };
+    int id = (current_pool == pool) ? current_worker
+                                    : (int)(atomic_fetch_add(&pool->next_deque, 1) % pool->n_threads);
+
+    // Counted as pending before it can be taken, so the count never drops to zero too early
+    atomic_fetch_add(&pool->pending, 1);
+    deque_push(&pool->deques[id], task);
+    atomic_fetch_add(&pool->queued, 1);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->task_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+/**
+ * Function: thread_pool_wait
+ * --------------------------
+ * Blocks until every submitted task has completed.
+ *
+ * Parameters:
+ * - pool: Pointer to the ThreadPool structure.
+ */
+void thread_pool_wait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->pending) > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+/**
+ * Function: thread_pool_destroy
+ * -----------------------------
+ * Runs the remaining tasks, stops the workers and frees the pool.
+ *
+ * Parameters:
+ * - pool: Pointer to the ThreadPool structure.
+ */
+void thread_pool_destroy(ThreadPool *pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->task_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->n_started; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->n_threads; i++) {
+        free(pool->deques[i].tasks);
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->task_available);
+    pthread_cond_destroy(&pool->all_done);
+    free(pool);
+}
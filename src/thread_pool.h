@@ -0,0 +1,23 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/**
+ * Type: TaskFunction
+ * ------------------
+ * Signature of a task executed by a worker thread of the pool.
+ */
+typedef void (*TaskFunction)(void *arg);
+
+typedef struct ThreadPool ThreadPool;
+
+int thread_pool_default_size(void);
+
+ThreadPool *thread_pool_create(int n_threads);
+
+void thread_pool_submit(ThreadPool *pool, TaskFunction function, void *arg);
+
+void thread_pool_wait(ThreadPool *pool);
+
+void thread_pool_destroy(ThreadPool *pool);
+
+#endif
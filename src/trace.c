@@ -0,0 +1,158 @@
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+
+// ---------------------------------------------------------------------------------------------------- //
+// --- TRACE EXPORT --- //
+
+
+/******************************************************************************
+ * Trace file
+ * Chrome trace-event JSON, readable by chrome://tracing and Perfetto:
+ *
+ *   {"traceEvents":[
+ *   {"name":"generate_puzzle","cat":"sudoku","ph":"X","ts":12.500,"dur":80311.250,"pid":1,"tid":1,"args":{"level":3}},
+ *   {"name":"dynamic_dig","cat":"sudoku","ph":"X","ts":40.125,"dur":2503.000,"pid":1,"tid":1},
+ *   ...
+ *   ]}
+ *
+ * Every span is a complete event ("ph":"X") with its start and duration in
+ * microseconds since the trace was opened. Threads are numbered from 1 in the
+ * order in which they record their first span. Events are written as the
+ * spans end, so nested spans appear before their parents.
+ ******************************************************************************/
+
+
+atomic_bool trace_enabled = false;
+
+static FILE *trace_file = NULL;
+static double trace_origin;
+static bool trace_first_event;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int trace_next_thread = 1;
+static _Thread_local int trace_thread = 0;
+
+
+/**
+ * Function: trace_clock
+ * ---------------------
+ * Returns a monotonic time in microseconds.
+ */
+static double trace_clock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e6 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec * 1e-3;
+#endif
+}
+
+
+/**
+ * Function: trace_open
+ * --------------------
+ * Starts recording the spans of every thread into a trace file. Must be called before the threads to be
+ * traced are started. The file is completed by `trace_close`, which also runs at exit.
+ *
+ * Parameters:
+ * - path: Path to the trace file, overwritten.
+ *
+ * Returns:
+ * - true if the file could be created,
+ *   false otherwise (tracing stays off).
+ */
+bool trace_open(const char *path) {
+    trace_file = fopen(path, "w");
+    if (trace_file == NULL) {
+        return false;
+    }
+    static bool registered = false;
+    if (!registered) {
+        atexit(trace_close);
+        registered = true;
+    }
+    fputs("{\"traceEvents\":[\n", trace_file);
+    trace_origin = trace_clock();
+    trace_first_event = true;
+    atomic_store_explicit(&trace_enabled, true, memory_order_relaxed);
+    return true;
+}
+
+
+/**
+ * Function: trace_close
+ * ---------------------
+ * Stops tracing and completes the trace file. Spans still ending on other threads (e.g. threads left
+ * running at exit) are dropped by `trace_end` rather than written into a closed file.
+ */
+void trace_close(void) {
+    pthread_mutex_lock(&trace_lock);
+    if (trace_file != NULL) {
+        atomic_store_explicit(&trace_enabled, false, memory_order_relaxed);
+        fputs("\n]}\n", trace_file);
+        fclose(trace_file);
+        trace_file = NULL;
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+
+/**
+ * Function: trace_begin
+ * ---------------------
+ * Begins a span; use TRACE_BEGIN or TRACE_SCOPE, which skip the call while tracing is off.
+ *
+ * Parameters:
+ * - name: Name of the span (a string literal: it is kept until the span ends).
+ * - arg_name: Name of an integer argument shown with the span, or NULL.
+ * - arg: Value of the argument.
+ *
+ * Returns:
+ * - The span, to be passed to `trace_end`.
+ */
+TraceSpan trace_begin(const char *name, const char *arg_name, long arg) {
+    TraceSpan span = { name, trace_clock(), arg_name, arg };
+    return span;
+}
+
+
+/**
+ * Function: trace_end
+ * -------------------
+ * Ends a span and records it in the trace file.
+ *
+ * Parameters:
+ * - span: Pointer to the TraceSpan structure returned by `trace_begin`.
+ */
+void trace_end(TraceSpan *span) {
+    double end = trace_clock();
+    if (trace_thread == 0) {
+        trace_thread = atomic_fetch_add(&trace_next_thread, 1);
+    }
+
+    pthread_mutex_lock(&trace_lock);
+    if (trace_file != NULL) {
+        fprintf(trace_file, "%s{\"name\":\"%s\",\"cat\":\"sudoku\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+                trace_first_event ? "" : ",\n", span->name, span->start - trace_origin, end - span->start, trace_thread);
+        if (span->arg_name != NULL) {
+            fprintf(trace_file, ",\"args\":{\"%s\":%ld}", span->arg_name, span->arg);
+        }
+        fputc('}', trace_file);
+        trace_first_event = false;
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
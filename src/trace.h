@@ -0,0 +1,46 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Type: TraceSpan
+ * ---------------
+ * A phase being timed: recorded as one complete event of the trace when it ends.
+ * Spans begun while tracing is off have no name and are ignored.
+ */
+typedef struct {
+    const char *name;
+    double start;
+    const char *arg_name;
+    long arg;
+} TraceSpan;
+
+extern atomic_bool trace_enabled;
+
+bool trace_open(const char *path);
+
+void trace_close(void);
+
+TraceSpan trace_begin(const char *name, const char *arg_name, long arg);
+
+void trace_end(TraceSpan *span);
+
+// While tracing is off a span costs one relaxed load of `trace_enabled`
+#define TRACE_BEGIN(name, arg_name, arg) \
+    (atomic_load_explicit(&trace_enabled, memory_order_relaxed) ? trace_begin((name), (arg_name), (arg)) : (TraceSpan){ NULL, 0.0, NULL, 0 })
+
+static inline void trace_scope_end(TraceSpan *span) {
+    if (span->name != NULL) trace_end(span);
+}
+
+// Spans ending when the enclosing block is left, however it is left (return, break, continue)
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE_ARG(name, arg_name, arg) \
+    TraceSpan TRACE_CONCAT(trace_span_, __LINE__) __attribute__((cleanup(trace_scope_end))) = TRACE_BEGIN(name, arg_name, arg)
+#define TRACE_SCOPE(name) TRACE_SCOPE_ARG(name, NULL, 0)
+
+#endif
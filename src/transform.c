@@ -0,0 +1,172 @@
+#include "transform.h"
+
+
+/******************************************************************************
+ * Symmetry Group
+ * Every transformation below maps a valid grid to a valid grid, and a puzzle
+ * to a puzzle with the same number of solutions. The group is generated by:
+ * - relabeling the digits (9!),
+ * - permuting the bands, and the rows inside each band (3! * 3!^3),
+ * - permuting the stacks, and the columns inside each stack (3! * 3!^3),
+ * - transposing the grid (2).
+ * Rotations and reflections are members of this group as well.
+ * All of them are composed into one Transform, so a variant costs one pass.
+ ******************************************************************************/
+
+
+/**
+ * Function: shuffle3
+ * ------------------
+ * Fills an array with a random permutation of 0, 1, 2.
+ */
+static void shuffle3(int order[3], Rng *rng) {
+    order[0] = 0;
+    order[1] = 1;
+    order[2] = 2;
+    for(int i = 2; i > 0; i--) {
+        int j = rng_int(rng, i + 1);
+        int temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
+}
+
+
+/**
+ * Function: transform_identity
+ * ----------------------------
+ * Initializes the transformation that leaves every grid unchanged.
+ *
+ * Parameters:
+ * - transform: Pointer to the Transform to initialize.
+ */
+void transform_identity(Transform *transform) {
+    for(int i = 0; i < N * N; i++) {
+        transform->cell[i] = i;
+    }
+    for(int d = 0; d <= 9; d++) {
+        transform->digit[d] = d;
+    }
+}
+
+
+/**
+ * Function: transform_build
+ * -------------------------
+ * Composes the generators of the group into a single Transform.
+ * Row r of the result is row 3 * band_order[r / 3] + row_order[r / 3][r % 3] of the source (after the optional
+ * transposition), and columns are mapped the same way through the stacks.
+ *
+ * Parameters:
+ * - transform: Pointer to the Transform to fill.
+ * - band_order: Source band of each destination band.
+ * - row_order: Source row, inside the band, of each destination row.
+ * - stack_order: Source stack of each destination stack.
+ * - col_order: Source column, inside the stack, of each destination column.
+ * - transpose: Whether the source grid is transposed first.
+ * - digit_map: New label of each digit 1–9 (digit_map[0] is ignored).
+ */
+void transform_build(
+    Transform *transform,
+    const int band_order[3],
+    const int row_order[3][3],
+    const int stack_order[3],
+    const int col_order[3][3],
+    bool transpose,
+    const int digit_map[10]
+) {
+    int row_map[N], col_map[N];
+    for(int i = 0; i < N; i++) {
+        row_map[i] = 3 * band_order[i / 3] + row_order[i / 3][i % 3];
+        col_map[i] = 3 * stack_order[i / 3] + col_order[i / 3][i % 3];
+    }
+    for(int r = 0; r < N; r++) {
+        for(int c = 0; c < N; c++) {
+            transform->cell[r * N + c] = transpose ? col_map[c] * N + row_map[r] : row_map[r] * N + col_map[c];
+        }
+    }
+    transform->digit[0] = 0;
+    for(int d = 1; d <= 9; d++) {
+        transform->digit[d] = digit_map[d];
+    }
+}
+
+
+/**
+ * Function: transform_random
+ * --------------------------
+ * Draws a uniformly random element of the symmetry group (9! * 3!^8 * 2 elements).
+ *
+ * Parameters:
+ * - transform: Pointer to the Transform to fill.
+ * - rng: Pointer to the random generator of the calling context.
+ */
+void transform_random(Transform *transform, Rng *rng) {
+    int band_order[3], stack_order[3];
+    int row_order[3][3], col_order[3][3];
+    int digit_map[10];
+
+    shuffle3(band_order, rng);
+    shuffle3(stack_order, rng);
+    for(int i = 0; i < 3; i++) {
+        shuffle3(row_order[i], rng);
+        shuffle3(col_order[i], rng);
+    }
+    bool transpose = rng_int(rng, 2) == 1;
+
+    for(int d = 0; d <= 9; d++) {
+        digit_map[d] = d;
+    }
+    for(int d = 9; d >= 2; d--) {
+        int j = rng_int(rng, d) + 1;
+        int temp = digit_map[d];
+        digit_map[d] = digit_map[j];
+        digit_map[j] = temp;
+    }
+
+    transform_build(transform, band_order, row_order, stack_order, col_order, transpose, digit_map);
+}
+
+
+/**
+ * Function: transform_apply
+ * -------------------------
+ * Applies a Transform in a single gather over the 81 cells.
+ *
+ * Parameters:
+ * - transform: Pointer to the Transform to apply.
+ * - source: Grid to transform.
+ * - result: Grid receiving the transformed grid (must not be `source`).
+ */
+void transform_apply(
+    const Transform *transform,
+    const Sudoku *source,
+    Sudoku *result
+) {
+    const int *from = &source->table[0][0];
+    int *to = &result->table[0][0];
+    for(int i = 0; i < N * N; i++) {
+        to[i] = transform->digit[from[transform->cell[i]]];
+    }
+}
+
+
+/**
+ * Function: random_transformations
+ * --------------------------------
+ * Replaces a grid with a random equivalent grid, drawn uniformly from the symmetry group.
+ *
+ * Parameters:
+ * - sudoku: Pointer to the Sudoku grid to be transformed.
+ * - rng: Pointer to the random generator of the calling context.
+ */
+void random_transformations(
+    Sudoku *sudoku,
+    Rng *rng
+) {
+    Transform transform;
+    Sudoku source = *sudoku;
+
+    transform_random(&transform, rng);
+    transform_apply(&transform, &source, sudoku);
+}
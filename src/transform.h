@@ -0,0 +1,41 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "io.h"
+#include "rng.h"
+#include <stdbool.h>
+
+/**
+ * Struct: Transform
+ * -----------------
+ * Element of the Sudoku symmetry group, stored as a cell permutation plus a digit relabeling.
+ * Applying it is a single gather: cell i of the result receives digit[cell i of the source].
+ *
+ * Fields:
+ * - cell: Index (row * 9 + col) of the source cell of each of the 81 destination cells.
+ * - digit: New label of each digit (digit[0] is 0, so empty cells stay empty).
+ */
+typedef struct {
+    unsigned char cell[N * N];
+    unsigned char digit[10];
+} Transform;
+
+void transform_identity(Transform *transform);
+
+void transform_build(
+    Transform *transform,
+    const int band_order[3],
+    const int row_order[3][3],
+    const int stack_order[3],
+    const int col_order[3][3],
+    bool transpose,
+    const int digit_map[10]
+);
+
+void transform_random(Transform *transform, Rng *rng);
+
+void transform_apply(const Transform *transform, const Sudoku *source, Sudoku *result);
+
+void random_transformations(Sudoku *sudoku, Rng *rng);
+
+#endif